@@ -3,6 +3,19 @@
 #ifndef SDTP_H
 #define SDTP_H
 
+// Positions and flags shared between producer and consumer threads
+#include <stddef.h>
+#include <stdint.h>
+#ifdef __cplusplus
+#include <atomic>
+typedef std::atomic<size_t> sdtp_atomic_size_t;
+typedef std::atomic<uint32_t> sdtp_atomic_uint32_t;
+#else
+#include <stdatomic.h>
+typedef _Atomic size_t sdtp_atomic_size_t;
+typedef _Atomic uint32_t sdtp_atomic_uint32_t;
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -15,9 +28,23 @@ extern "C" {
 
 #define SDTP_TERMINATOR (uint8_t)0x04
 #define SDTP_START_OF_HEADER (uint8_t)0x02
+#define SDTP_START_OF_COMPACT (uint8_t)0x01
 
 // INSTANCE AND CONFIG //
 
+/**
+ * Memory allocator interface.
+ * Library allocations of an instance, its buffers and its packets go through it.
+ * @param alloc Allocates size bytes (returns NULL on failure).
+ * @param free Frees memory returned by alloc; size is the requested size.
+ * @param ctx Opaque pointer passed to both functions.
+ **/
+typedef struct {
+	void* (*alloc)(void* ctx, size_t size);
+	void  (*free)(void* ctx, void* ptr, size_t size);
+	void* ctx;
+} sdtp_allocator_t;
+
 /**
  * Buffer types.
  * Can be either input or output buffer.
@@ -28,18 +55,79 @@ typedef enum {
 } sdtp_buffer_type_t;
 
 /**
- * LILO linear buffer for storing serial data.
- * @param size Total buffer size.
- * @param tail Current position.
+ * What sdtp_buffer_write() does when data doesn't fit.
+ * @param SDTP_OVERFLOW_REJECT Write what fits and return the short count
+ * @param SDTP_OVERFLOW_WIPE Drop all buffered data first unless views hold some (legacy behavior, default)
+ * @param SDTP_OVERFLOW_DROP_OLDEST Drop whole frames from the head, never a part of one
+ * @param SDTP_OVERFLOW_GROW Reallocate buffer memory up to max_size
+ **/
+typedef enum {
+	SDTP_OVERFLOW_REJECT = 0,
+	SDTP_OVERFLOW_WIPE,
+	SDTP_OVERFLOW_DROP_OLDEST,
+	SDTP_OVERFLOW_GROW,
+} sdtp_overflow_policy_t;
+
+typedef struct sdtp_buffer sdtp_buffer_t;
+
+/**
+ * Called when used space reaches the high watermark, and again once it falls
+ * to the low watermark. Runs on the thread which moved the level.
+ * @param buffer Buffer whose level crossed a watermark.
+ * @param high True for the high watermark, false for the low one.
+ * @param ctx Opaque pointer given together with the callback.
+ **/
+typedef void (*sdtp_watermark_callback_t)(sdtp_buffer_t* buffer, bool high, void* ctx);
+
+/**
+ * FIFO ring buffer for storing serial data.
+ * Capacity is always a power of two, so positions are wrapped with a mask.
+ * Head and tail are free-running counters: used space is (tail - head).
+ * Head is advanced only by the consumer and tail only by the producer, so one
+ * producer and one consumer may run concurrently (see sdtp_buffer_push()).
+ * @param size Total buffer size (power of two).
+ * @param mask Index mask (size - 1).
+ * @param head Read position.
+ * @param tail Write position.
  * @param data Pointer to start of the buffer memory.
+ * @param allocator Allocator which owns the buffer (NULL - libc).
+ * @param owns_memory False if the buffer was set up by sdtp_buffer_init() on caller memory.
+ * @param concurrent Producer and consumer run concurrently: the consumer never rewinds
+ * an empty buffer and the producer only rejects on overflow.
+ * @param overflow Overflow policy (enum sdtp_overflow_policy_t).
+ * @param max_size Size limit of SDTP_OVERFLOW_GROW, frames up to it are awaited while the buffer grows.
+ * @param pinned Bytes at the head held by packet views, never dropped or moved by overflow handling.
+ * @param dropped Bytes dropped by overflow handling so far.
+ * @param low_watermark Low watermark in bytes.
+ * @param high_watermark High watermark in bytes.
+ * @param on_watermark Watermark callback (NULL - none).
+ * @param watermark_ctx Opaque pointer passed to the callback.
+ * @param above_high Whether the high watermark was reported last.
  **/
-typedef struct {
+struct sdtp_buffer {
 	size_t size;
+	size_t mask;
 
-	uint8_t* tail;
+	sdtp_atomic_size_t head;
+	sdtp_atomic_size_t tail;
 
 	uint8_t* data;
-} sdtp_buffer_t;
+
+	const sdtp_allocator_t* allocator;
+	bool owns_memory;
+	bool concurrent;
+
+	sdtp_overflow_policy_t overflow;
+	size_t max_size;
+	size_t pinned;
+	size_t dropped;
+
+	size_t low_watermark;
+	size_t high_watermark;
+	sdtp_watermark_callback_t on_watermark;
+	void* watermark_ctx;
+	sdtp_atomic_uint32_t above_high;
+};
 
 /**
  * Reading mode for buffer.
@@ -59,6 +147,8 @@ typedef enum {
  * @param output_bus_pin Port number for output channel.
  * @param buffer_size Buffers size.
  * @param baud_rate Baud rate (bits per second).
+ * @param allocator Allocator for instance memory (NULL - libc malloc/free). Must outlive the instance.
+ * @param concurrent_input Input buffer is fed from an ISR or another thread with sdtp_io_push().
  **/
 typedef struct {
 	uint8_t input_bus_pin;
@@ -67,21 +157,72 @@ typedef struct {
 	size_t buffer_size;
 
 	uint32_t baud_rate;
+
+	const sdtp_allocator_t* allocator;
+
+	bool concurrent_input;
 } sdtp_config_t;
 
 /**
- * Single SDTP instance.
- * Contains I/O buffers and config.
- * Should be created only with sdtp_instance_create().
+ * Time source.
+ * @param ctx Opaque pointer given together with the clock.
+ * @return Current time in microseconds (any epoch, must not go backwards).
+ **/
+typedef uint64_t (*sdtp_clock_t)(void* ctx);
+
+/**
+ * Output coalescing settings.
+ * While enabled, written packets only fill the output buffer until a threshold is hit.
+ * @param enabled Whether coalescing is enabled.
+ * @param flush_threshold Flush once this many bytes are pending (0 - whole buffer).
+ * @param flush_deadline_us Flush once the oldest pending packet is this old (0 - no deadline).
  **/
 typedef struct {
-	sdtp_config_t config;
+	bool enabled;
 
-	sdtp_buffer_t* input_buffer;
-	sdtp_buffer_t* output_buffer;
+	size_t flush_threshold;
+	uint64_t flush_deadline_us;
+} sdtp_coalesce_config_t;
 
-	const sdtp_function_hooks* function_hooks;
-} sdtp_instance_t;
+// CHECKSUM //
+
+/**
+ * Streaming Fletcher-32 state.
+ * Lets data be checksummed piece by piece as it arrives or is written.
+ * @param c0 First sum (mod 65535).
+ * @param c1 Second sum (mod 65535).
+ * @param carry Odd byte waiting for its pair from the next update.
+ * @param has_carry Whether carry is valid.
+ **/
+typedef struct {
+	uint32_t c0;
+	uint32_t c1;
+
+	uint8_t carry;
+	bool has_carry;
+} sdtp_fletcher32_state_t;
+
+/**
+ * Fletcher-32 block kernels, all give the same checksum.
+ * @param SDTP_CHECKSUM_AUTO Fastest one the running CPU supports
+ * @param SDTP_CHECKSUM_SCALAR Portable C
+ * @param SDTP_CHECKSUM_SSE2 x86-64 SSE2
+ * @param SDTP_CHECKSUM_AVX2 x86-64 AVX2
+ * @param SDTP_CHECKSUM_NEON ARM NEON (little endian)
+ **/
+typedef enum {
+	SDTP_CHECKSUM_AUTO,
+	SDTP_CHECKSUM_SCALAR,
+	SDTP_CHECKSUM_SSE2,
+	SDTP_CHECKSUM_AVX2,
+	SDTP_CHECKSUM_NEON,
+} sdtp_checksum_kernel_t;
+
+/**
+ * Chunk size used by checksumming copies.
+ * Chunks stay in L1 cache between the copy and the checksum.
+ **/
+#define SDTP_FLETCHER32_CHUNK 4096
 
 // PACKETS //
 
@@ -93,6 +234,7 @@ typedef enum {
 	SDTP_DISCONNECT  = 1,
 	SDTP_ERROR       = 2,
 	SDTP_DATA_PACKET = 3,
+	SDTP_ACK         = 4,
 } sdtp_packet_type_t;
 
 /**
@@ -114,12 +256,117 @@ typedef struct {
  * Standard SDTP packet.
  * Contains packet header and body.
  * Should be created only with sdtp_construct_packet().
+ * Allocated packets keep the body right after the struct when possible,
+ * so a packet costs a single allocation.
  **/
 typedef struct {
-	sdtp_packet_header_t header; // Packet header
-	uint8_t* body;               // Packet body
+	sdtp_packet_header_t header;        // Packet header
+	uint8_t* body;                      // Packet body
+	const sdtp_allocator_t* allocator;  // Allocator which owns the packet (NULL - libc)
+	bool body_inline;                   // Whether body is in the packet block (set by sdtp_packet_alloc())
 } sdtp_packet_t;
 
+/**
+ * Packet type flags.
+ * Top byte of the type is reserved for flags, user-defined types must not use it.
+ **/
+#define SDTP_TYPE_FLAGS    0xFF000000u
+#define SDTP_TYPE_FRAGMENT 0x80000000u // Body starts with a fragment prefix
+#define SDTP_TYPE_RELIABLE 0x40000000u // Body starts with a sequence number
+#define SDTP_TYPE_COMPRESSED 0x20000000u // Body is compressed with sdtp_compress()
+
+// Type without flags
+#define SDTP_TYPE_BASE(type) ((uint32_t)(type) & ~SDTP_TYPE_FLAGS)
+
+/*******************************************************
+ * Fragment body layout:
+ * Total size: uint32_t (size of the whole payload)
+ * Offset: uint32_t (position of this part in the payload)
+ * Data: part of the payload
+ ******************************************************/
+
+#define SDTP_FRAGMENT_PREFIX_SIZE (2 * sizeof(uint32_t))
+
+/*******************************************************
+ * Reliable body layout:
+ * Sequence: uint32_t
+ * Data: payload (fragmented as a whole if it doesn't fit)
+ *
+ * Ack body layout (SDTP_ACK):
+ * Cumulative: uint32_t (every sequence before it was received)
+ * Selective: uint32_t (bit i - sequence cumulative + 1 + i was received)
+ ******************************************************/
+
+#define SDTP_RELIABLE_PREFIX_SIZE sizeof(uint32_t)
+#define SDTP_ACK_SIZE (2 * sizeof(uint32_t))
+
+/*******************************************************
+ * Compressed body layout:
+ * Size: uint32_t (size of the original payload)
+ * Data: sdtp_compress() stream
+ *
+ * Handshake body layout (SDTP_HANDSHAKE):
+ * Features: uint32_t (SDTP_FEATURE_* the sender accepts and SDTP_HANDSHAKE_REPLY
+ *           on answers, empty body - request without features)
+ ******************************************************/
+
+#define SDTP_COMPRESS_PREFIX_SIZE sizeof(uint32_t)
+
+// Features negotiated by handshakes
+#define SDTP_FEATURE_COMPRESSION    0x1u
+#define SDTP_FEATURE_COMPACT_HEADER 0x2u
+// Handshake answers a request (never a feature)
+#define SDTP_HANDSHAKE_REPLY        0x80000000u
+
+// PACKET POOL //
+
+#define SDTP_POOL_MAX_CLASSES 8
+
+/**
+ * Single size class of a packet pool.
+ * @param block_size Block size in bytes.
+ * @param block_count Number of blocks.
+ * @param start First block.
+ * @param end End of the last block.
+ * @param free_list First free block (each free block stores a pointer to the next).
+ * @param free_count Number of free blocks.
+ **/
+typedef struct {
+	size_t block_size;
+	size_t block_count;
+
+	uint8_t* start;
+	uint8_t* end;
+
+	void* free_list;
+	size_t free_count;
+} sdtp_pool_class_t;
+
+/**
+ * Fixed-size block pool with size classes.
+ * Allocation takes the smallest class with a free block that fits, so
+ * recycling packets never touches the heap and takes constant time.
+ * Pool is not thread-safe: use one pool per instance or per thread.
+ * @param classes Size classes ordered by block size.
+ * @param class_count Number of classes.
+ * @param storage Memory of all blocks.
+ * @param storage_size Size of storage.
+ * @param owns_storage Whether storage was allocated by the pool.
+ * @param fallback Allocator used when no block fits (NULL - fail).
+ * @param allocator Allocator interface of this pool.
+ **/
+typedef struct {
+	sdtp_pool_class_t classes[SDTP_POOL_MAX_CLASSES];
+	size_t class_count;
+
+	uint8_t* storage;
+	size_t storage_size;
+	bool owns_storage;
+
+	const sdtp_allocator_t* fallback;
+	sdtp_allocator_t allocator;
+} sdtp_pool_t;
+
 /*******************************************************
  * Serialized packet layout:
  * Start of heading: 1 byte
@@ -128,156 +375,1615 @@ typedef struct {
  * Terminator: 1 byte
  ******************************************************/
 
-// INSTANCE MANIPULATION //
+#define SDTP_HEADER_SIZE (4 * sizeof(uint32_t))
+#define SDTP_FRAME_SIZE(data_size) (1 + SDTP_HEADER_SIZE + (size_t)(data_size) + 1)
+
+/*******************************************************
+ * Compact packet layout:
+ * Start of compact: 1 byte
+ * Format: 1 byte (id size code << 6 | checksum size code << 4 | type flags >> 28)
+ * Length: varint (7 bits per byte, low first, up to 5 bytes)
+ * Type: 1 byte (type without flags)
+ * ID: 0, 1, 2 or 4 bytes (little endian, low bytes of the id)
+ * Checksum: 1, 2 or 4 bytes (little endian, Fletcher-32 of format to ID and body, see sdtp_checksum_fold())
+ * Body: data_size bytes
+ * Terminator: 1 byte
+ * Size codes: 0, 1, 2, 3 for 0, 1, 2, 4 bytes (checksum can't be empty)
+ ******************************************************/
+
+// Largest header of both layouts, with the start byte
+#define SDTP_HEAD_MAX_SIZE (1 + SDTP_HEADER_SIZE)
 
 /**
- * @brief Creates new SDTP instance and returns pointer to it.
- * Config is copied.
+ * Compact header format.
+ * Frames whose id, type or flags don't fit are sent with the full header,
+ * ids are never truncated.
+ * @param id_size ID bytes (0 - only id 0 goes compact, 1, 2 or 4).
+ * @param checksum_size Checksum bytes (1, 2 or 4).
  **/
-sdtp_instance_t* sdtp_instance_create(const sdtp_config_t* config, const sdtp_function_hooks* gpio_hooks);
+typedef struct {
+	uint8_t id_size;
+	uint8_t checksum_size;
+} sdtp_header_format_t;
+
+// Maximum segments of a single vectored write
+#define SDTP_IOV_MAX 16
+
+// OUTPUT QUEUE //
+
+/*******************************************************
+ * Queue record layout (4-byte aligned):
+ * Record size: uint32_t (0 until the producer commits)
+ * Frame size: uint32_t
+ * Frame: serialized packet, padded to 4 bytes
+ ******************************************************/
+
+#define SDTP_QUEUE_RECORD_HEADER_SIZE (2 * sizeof(uint32_t))
+#define SDTP_QUEUE_RECORD_SIZE(frame_size) (SDTP_QUEUE_RECORD_HEADER_SIZE + (((size_t)(frame_size) + 3) & ~(size_t)3))
+
 /**
- * @brief Frees and closes instance.
- * Config is not freed.
+ * Multi-producer single-consumer frame queue.
+ * Producers reserve a record by advancing tail with compare-and-swap, serialize
+ * the frame into it and commit it by setting the record size. The single flusher
+ * takes committed records in order, so frames never interleave.
+ * @param size Queue size in bytes (power of two).
+ * @param mask Index mask (size - 1).
+ * @param head Flusher position.
+ * @param tail Reservation position.
+ * @param data Queue memory.
+ * @param words Queue memory as 4-byte words (record headers).
+ * @param allocator Allocator which owns the queue (NULL - libc).
+ * @param owns_memory False if the queue was set up by sdtp_queue_init() on caller memory.
  **/
-void sdtp_instance_close(sdtp_instance_t* instance);
+typedef struct {
+	size_t size;
+	size_t mask;
 
-// PACKET MANIPULATION //
+	sdtp_atomic_size_t head;
+	sdtp_atomic_size_t tail;
+
+	uint8_t* data;
+	sdtp_atomic_uint32_t* words;
+
+	const sdtp_allocator_t* allocator;
+	bool owns_memory;
+} sdtp_queue_t;
+
+// PARSER //
 
 /**
- * @brief Allocates and constructs a new packet.
- * Caller must free returned pointer.
- * @param data Buffer with packet data.
- * @param packet_type Type of the packet (enum sdtp_packet_type_t)
- * @param packet_id Packet ID (must be random).
- * @return Pointer to allocated packet struct.
+ * Stream parser states.
+ * @param SDTP_PARSER_SEEK Searching for a start byte
+ * @param SDTP_PARSER_HEADER Waiting for the whole header
+ * @param SDTP_PARSER_BODY Waiting for the body and terminator
+ * @param SDTP_PARSER_READY Complete and verified frame is at the parser position
  **/
-sdtp_packet_t* sdtp_construct_packet(const char* data, sdtp_packet_type_t packet_type, uint32_t packet_id);
+typedef enum {
+	SDTP_PARSER_SEEK,
+	SDTP_PARSER_HEADER,
+	SDTP_PARSER_BODY,
+	SDTP_PARSER_READY,
+} sdtp_parser_state_t;
+
 /**
- * @brief Frees packet and body data.
+ * Resumable frame parser.
+ * Keeps progress between reads, so frames split across reads are not lost.
+ * Parser position is offset bytes past the buffer head, bytes before it are
+ * held by unreleased packet views.
+ * @param state Current state (enum sdtp_parser_state_t).
+ * @param header Header of the current frame (valid from SDTP_PARSER_BODY).
+ * @param head_size Header bytes of the current frame with the start byte (valid from SDTP_PARSER_BODY).
+ * @param checksum_size Checksum bytes of the current frame (valid from SDTP_PARSER_BODY).
+ * @param checksum Checksum of the body bytes received so far.
+ * @param checked Body bytes already added to checksum.
+ * @param offset Parser position relative to the buffer head.
+ * @param lead Bytes skipped since the last view was taken.
+ * @param views Number of unreleased views.
+ * @param dropped Buffer overflow drop count the current frame was parsed against.
+ * @param compact Whether compact headers are accepted, kept by sdtp_parser_reset().
  **/
-void sdtp_packet_free(sdtp_packet_t* packet);
+typedef struct {
+	sdtp_parser_state_t state;
+	sdtp_packet_header_t header;
+	size_t head_size;
+	size_t checksum_size;
+
+	sdtp_fletcher32_state_t checksum;
+	size_t checked;
+
+	size_t offset;
+	size_t lead;
+	size_t views;
+
+	size_t dropped;
+
+	bool compact;
+} sdtp_parser_t;
 
 /**
- * @brief Serializes packet to a newly allocated buffer.
- * Returned data is in host byte order.
- * Caller must free returned pointer.
- * @param packet Pointer to target packet.
- * @param out_size Var which receives the size in bytes of the returned buffer.
- * @return Pointer to allocated buffer with serialized packet.
+ * Borrowed packet.
+ * Body points into the instance input storage and stays valid until
+ * sdtp_packet_view_release(). Views must be released in the order they were read.
+ * @param header Decoded packet header.
+ * @param body Pointer to header.data_size body bytes (NULL if empty).
+ * @param span Input buffer bytes released together with the view.
  **/
-uint8_t* sdtp_serialize_packet(const sdtp_packet_t* packet, size_t* out_size);
+typedef struct {
+	sdtp_packet_header_t header;
+	const uint8_t* body;
+
+	size_t span;
+} sdtp_packet_view_t;
+
+// DISPATCH //
+
+typedef struct sdtp_instance sdtp_instance_t;
+
+// Number of built-in packet types (enum sdtp_packet_type_t)
+#define SDTP_DISPATCH_TYPE_COUNT 5
+// Maximum user-defined type ranges of a single instance
+#define SDTP_DISPATCH_MAX_RANGES 8
+
 /**
- * @brief Deserializes raw byte data from a buffer to a newly allocated packet.
- * Returned data is in sender host byte order.
- * Caller must free returned pointer.
- * @param buffer Buffer with serialized target packet.
- * @param buf_size Size of the buffer.
- * @return Pointer to allocated packet struct.
+ * Called for every dispatched packet.
+ * View is borrowed: it's released right after the handler returns.
+ * @param instance Instance which received the packet.
+ * @param view Received packet.
+ * @param ctx Opaque pointer given together with the handler.
  **/
-sdtp_packet_t* sdtp_deserialize_packet(const uint8_t* buffer, size_t buf_size);
+typedef void (*sdtp_packet_handler_t)(sdtp_instance_t* instance, const sdtp_packet_view_t* view, void* ctx);
 
-// BUFFER MANIPULATION //
+/**
+ * Registered handler.
+ * @param handler Handler function (NULL - none).
+ * @param ctx Opaque pointer passed to the handler.
+ **/
+typedef struct {
+	sdtp_packet_handler_t handler;
+	void* ctx;
+} sdtp_handler_entry_t;
 
 /**
- * @brief Creates a new buffer.
- * Caller must free returned pointer.
- * @param config Pointer to SDTP configuration.
- * @return Pointer to allocated data buffer.
+ * Handler of an inclusive range of packet types.
+ * @param first First type of the range.
+ * @param last Last type of the range.
+ * @param entry Handler of the range.
  **/
-sdtp_buffer_t* sdtp_buffer_create(const sdtp_config_t* config);
+typedef struct {
+	uint32_t first;
+	uint32_t last;
+
+	sdtp_handler_entry_t entry;
+} sdtp_handler_range_t;
+
 /**
- * @brief Frees buffer and data.
- * Caller must set buffer pointer to NULL.
+ * Packet dispatch table.
+ * Lookup order: built-in type handler, ranges in registration order, fallback.
+ * @param types Handlers of built-in types indexed by type.
+ * @param ranges User-defined type ranges.
+ * @param range_count Number of ranges.
+ * @param fallback Handler of packets nothing else matched (NULL - drop them).
+ * @param unhandled Number of dropped packets.
  **/
-void sdtp_buffer_free(sdtp_buffer_t* buffer);
+typedef struct {
+	sdtp_handler_entry_t types[SDTP_DISPATCH_TYPE_COUNT];
+
+	sdtp_handler_range_t ranges[SDTP_DISPATCH_MAX_RANGES];
+	size_t range_count;
+
+	sdtp_handler_entry_t fallback;
+	size_t unhandled;
+} sdtp_dispatch_table_t;
 
 /**
- * @brief Writes byte stream into the buffer.
- * @param buffer Buffer to write.
- * @param source Buffer with data to write.
- * @param write_len Buffer length.
- * @return Written length.
+ * Link states.
+ * @param SDTP_LINK_DOWN No handshake exchanged (or peer disconnected)
+ * @param SDTP_LINK_CONNECTING Handshake sent, waiting for the reply
+ * @param SDTP_LINK_UP Handshake exchanged
  **/
-size_t sdtp_buffer_write(sdtp_buffer_t* buffer, const uint8_t* source, size_t write_len);
+typedef enum {
+	SDTP_LINK_DOWN,
+	SDTP_LINK_CONNECTING,
+	SDTP_LINK_UP,
+} sdtp_link_state_t;
+
 /**
- * @brief Reads byte stream from the buffer.
- * @param buffer Buffer to read.
- * @param destination Buffer into which data will be copied.
- * @param read_len Length to read.
- * @param mode Reading mode (enum sdtp_read_mode_t).
- * @return Read length.
+ * Link state kept by sdtp_dispatch() from control packets.
+ * @param state Current state (enum sdtp_link_state_t).
+ * @param peer_features Features from the last peer handshake (SDTP_FEATURE_*).
+ * @param errors Number of received SDTP_ERROR packets.
+ * @param last_error_id ID of the last received SDTP_ERROR packet.
  **/
-size_t sdtp_buffer_read(sdtp_buffer_t* buffer, uint8_t* destination, size_t read_len, sdtp_read_mode_t mode);
+typedef struct {
+	sdtp_link_state_t state;
+	uint32_t peer_features;
+
+	size_t errors;
+	uint32_t last_error_id;
+} sdtp_link_t;
+
+// OUTPUT PRIORITY //
+
+#define SDTP_PRIORITY_CLASSES 3
 
 /**
- * @brief Clears buffer.
- * @param instance SDTP instance.
- * @param buffer_type Type of buffer to clear.
+ * Output priority classes.
+ * By default control packets are SDTP_PRIORITY_HIGH and everything else SDTP_PRIORITY_NORMAL.
  **/
-void sdtp_buffer_clear(sdtp_instance_t* instance, sdtp_buffer_type_t buffer_type);
+typedef enum {
+	SDTP_PRIORITY_HIGH   = 0,
+	SDTP_PRIORITY_NORMAL = 1,
+	SDTP_PRIORITY_LOW    = 2,
+} sdtp_priority_t;
 
 /**
- * @brief Gets used buffer space.
+ * Scheduling between priority classes (always at frame boundaries).
+ * @param SDTP_SCHEDULE_STRICT Lower class waits while a higher class has frames
+ * @param SDTP_SCHEDULE_WEIGHTED Deficit round robin, each class gets its weight in bytes per round
  **/
-size_t sdtp_buffer_get_used_space(const sdtp_buffer_t* buffer);
+typedef enum {
+	SDTP_SCHEDULE_STRICT,
+	SDTP_SCHEDULE_WEIGHTED,
+} sdtp_schedule_t;
+
 /**
- * @brief Gets pointer to a buffer from an SDTP instance by type.
+ * Priority output settings.
+ * @param schedule Scheduling between classes.
+ * @param queue_size Size of each class queue (power of two, 0 - buffer_size).
+ * @param weights Bytes per round of each class (SDTP_SCHEDULE_WEIGHTED only, must not be 0).
  **/
-sdtp_buffer_t* sdtp_buffer_get_by_type(sdtp_instance_t* instance, sdtp_buffer_type_t buffer_type);
+typedef struct {
+	sdtp_schedule_t schedule;
+	size_t queue_size;
 
-// INSTANCE BUFFER MANIPULATION //
+	uint32_t weights[SDTP_PRIORITY_CLASSES];
+} sdtp_priority_config_t;
 
 /**
- * @brief Writes a single packet into output buffer.
- * Packet is not freed.
- * @param instance SDTP instance.
- * @param packet Packet to write.
- * @return Status (false - error, true - success).
+ * Priority output state.
+ * Written frames wait in the queue of their class and are moved to the output
+ * buffer in scheduling order whenever it's flushed.
+ * @param enabled Whether frames go through class queues.
+ * @param schedule Scheduling between classes.
+ * @param queues Frame queue of each class.
+ * @param weights Bytes per round of each class.
+ * @param deficits Bytes each class may still send this round.
+ * @param current Class served by the weighted scheduler.
+ * @param charged Whether current class got its weight this round.
+ * @param type_priority Class of each built-in packet type.
+ * @param storage Memory of all queues.
+ * @param owns_storage Whether storage was allocated by the instance.
  **/
-bool sdtp_write_packet(sdtp_instance_t* instance, const sdtp_packet_t* packet);
+typedef struct {
+	bool enabled;
+	sdtp_schedule_t schedule;
+
+	sdtp_buffer_t queues[SDTP_PRIORITY_CLASSES];
+
+	uint32_t weights[SDTP_PRIORITY_CLASSES];
+	size_t deficits[SDTP_PRIORITY_CLASSES];
+	size_t current;
+	bool charged;
+
+	sdtp_priority_t type_priority[SDTP_DISPATCH_TYPE_COUNT];
+
+	uint8_t* storage;
+	bool owns_storage;
+} sdtp_scheduler_t;
+
 /**
- * @brief Reads a single packet from the input buffer and returns pointer to it.
- * Caller must free returned pointer.
- * @param instance SDTP instance.
- * @param mode Reading mode (enum sdtp_read_mode_t).
- * @return Pointer to allocated packet struct.
+ * Storage size for sdtp_instance_set_priorities().
  **/
-sdtp_packet_t* sdtp_read_packet(sdtp_instance_t* instance, sdtp_read_mode_t mode);
+#define SDTP_PRIORITY_STORAGE_SIZE(queue_size) (SDTP_PRIORITY_CLASSES * (size_t)(queue_size))
 
-// IO MANIPULATION //
+// REASSEMBLY //
+
+// Payloads reassembled at the same time
+#define SDTP_REASSEMBLY_SLOTS 4
+// Disjoint received ranges of a single payload (more - fragment is dropped)
+#define SDTP_REASSEMBLY_MAX_RANGES 8
 
 /**
- * @brief Writes data from output buffer to IO output via function hook.
- * @return Status (false - error, true - success).
+ * Reassembly settings.
+ * @param max_bytes Total size of payloads being reassembled at once.
+ * @param timeout_us Payload is dropped if not complete this long after its first fragment (0 - never).
  **/
-bool sdtp_io_write(sdtp_instance_t* instance);
+typedef struct {
+	size_t max_bytes;
+	uint64_t timeout_us;
+} sdtp_reassembly_config_t;
+
 /**
- * @brief Writes data from IO input to input buffer via function hook.
- * @return Status (false - error, true - success).
- */
-bool sdtp_io_read(sdtp_instance_t* instance);
+ * Received part of a payload [start, end).
+ **/
+typedef struct {
+	uint32_t start;
+	uint32_t end;
+} sdtp_range_t;
 
-// MISC //
+/**
+ * Payload being reassembled.
+ * @param used Whether the slot is taken.
+ * @param id Packet ID shared by all fragments.
+ * @param packet Packet which receives the payload.
+ * @param ranges Received ranges, sorted and merged.
+ * @param range_count Number of ranges.
+ * @param started Time of the first fragment.
+ **/
+typedef struct {
+	bool used;
+	uint32_t id;
+
+	sdtp_packet_t* packet;
+
+	sdtp_range_t ranges[SDTP_REASSEMBLY_MAX_RANGES];
+	size_t range_count;
+
+	uint64_t started;
+} sdtp_reassembly_slot_t;
 
 /**
- * @brief Converts packet data to char.
- * Caller must free returned and packet pointer.
- * @return packet->body converted from raw bytes to null-terminated char.
- */
-char* sdtp_get_char_data(const sdtp_packet_t* packet);
+ * Reassembly state.
+ * Fragments are matched by packet ID and may arrive in any order.
+ * @param enabled Whether fragments are reassembled (false - delivered as they are).
+ * @param config Reassembly settings.
+ * @param used_bytes Size of payloads being reassembled.
+ * @param slots Payloads being reassembled.
+ * @param dropped Number of dropped fragments.
+ * @param expired Number of payloads dropped by timeout.
+ **/
+typedef struct {
+	bool enabled;
+	sdtp_reassembly_config_t config;
+
+	size_t used_bytes;
+	sdtp_reassembly_slot_t slots[SDTP_REASSEMBLY_SLOTS];
+
+	size_t dropped;
+	size_t expired;
+} sdtp_reassembly_t;
+
 /**
- * @brief Converts chars to uint8_t.
- * Caller must free returned and source buffer pointer.
- * @param source Buffer with data to convert.
- * @param data_len Converted bytes length.
- * @return Buffer with converted data.
- */
-uint8_t* sdtp_char_to_bytes(const char* source, size_t* data_len);
+ * Fragmented payload left unfinished by a busy channel.
+ * Writing the same packet again continues after the fragments already output.
+ * @param active Whether a payload is unfinished.
+ * @param id Packet ID of the payload.
+ * @param type Type of the fragments without SDTP_TYPE_FRAGMENT.
+ * @param data_size Payload size.
+ * @param offset Payload bytes already output.
+ **/
+typedef struct {
+	bool active;
+	uint32_t id;
+	uint32_t type;
+	size_t data_size;
+	size_t offset;
+} sdtp_fragment_progress_t;
+
+// RELIABLE DELIVERY //
+
+// Frames in flight at most (one selective ack bitmap)
+#define SDTP_RELIABLE_MAX_WINDOW 32
 
 /**
- * @brief Calculates Fletcher-32 checksum
- */
-uint32_t sdtp_calculate_fletcher32(const uint8_t *data, size_t len);
+ * Reliable delivery settings.
+ * @param window Frames in flight (1 to SDTP_RELIABLE_MAX_WINDOW).
+ * @param storage_size Size of the retransmit store (power of two, 0 - 4 output buffers).
+ * @param initial_rto_us Retransmit timeout until the first round trip is measured.
+ * @param min_rto_us Lower retransmit timeout limit.
+ * @param max_rto_us Upper retransmit timeout limit.
+ * @param max_retries Retransmits of a frame before the link is considered down (0 - unlimited).
+ **/
+typedef struct {
+	size_t window;
+	size_t storage_size;
+
+	uint64_t initial_rto_us;
+	uint64_t min_rto_us;
+	uint64_t max_rto_us;
+
+	uint32_t max_retries;
+} sdtp_reliable_config_t;
+
+/**
+ * Frame in flight.
+ * @param body_size Body size in the retransmit store (with sequence).
+ * @param type Packet type (with SDTP_TYPE_RELIABLE).
+ * @param id Packet ID.
+ * @param sent_at Time of the last transmission.
+ * @param retransmits Number of retransmissions.
+ * @param acked Whether the peer has the frame.
+ **/
+typedef struct {
+	size_t body_size;
+	uint32_t type;
+	uint32_t id;
+
+	uint64_t sent_at;
+	uint32_t retransmits;
+	bool acked;
+} sdtp_reliable_slot_t;
+
+/**
+ * Reliable delivery state.
+ * Sender keeps bodies of unacknowledged frames in a ring and retransmits only
+ * the ones the peer didn't acknowledge. Round trip time is estimated with
+ * Jacobson's algorithm, retransmitted frames aren't sampled (Karn's rule).
+ * Receiver suppresses duplicates and delivers frames in sequence order,
+ * frames which arrive early are copied and held until the gap is repaired.
+ * @param enabled Whether reliable frames and acks are processed.
+ * @param config Reliable delivery settings.
+ * @param store Bodies of frames in flight.
+ * @param storage Memory of the store.
+ * @param owns_storage Whether storage was allocated by the instance.
+ * @param slots Frames in flight indexed by sequence.
+ * @param send_base Oldest unacknowledged sequence.
+ * @param send_next Next sequence to send.
+ * @param recv_next Next expected sequence.
+ * @param recv_bitmap Received sequences after recv_next (bit i - recv_next + 1 + i).
+ * @param deliver_next Next sequence to deliver (frames up to recv_next are held).
+ * @param held Frames which arrived early indexed by sequence (without the sequence).
+ * @param ack_pending Whether an ack should be sent.
+ * @param srtt_us Smoothed round trip time.
+ * @param rttvar_us Round trip time variation.
+ * @param rto_us Current retransmit timeout.
+ * @param has_rtt Whether a round trip was measured.
+ * @param retransmits Number of retransmitted frames.
+ * @param failures Number of times max_retries was exceeded.
+ **/
+typedef struct {
+	bool enabled;
+	sdtp_reliable_config_t config;
+
+	sdtp_buffer_t store;
+	uint8_t* storage;
+	bool owns_storage;
+
+	sdtp_reliable_slot_t slots[SDTP_RELIABLE_MAX_WINDOW];
+	uint32_t send_base;
+	uint32_t send_next;
+
+	uint32_t recv_next;
+	uint32_t recv_bitmap;
+	uint32_t deliver_next;
+	sdtp_packet_t* held[SDTP_RELIABLE_MAX_WINDOW];
+	bool ack_pending;
+
+	uint64_t srtt_us;
+	uint64_t rttvar_us;
+	uint64_t rto_us;
+	bool has_rtt;
+
+	size_t retransmits;
+	size_t failures;
+} sdtp_reliable_t;
+
+// COMPRESSION //
+
+/*******************************************************
+ * Compressed stream is a list of sequences:
+ * Token: uint8_t (literal count << 4 | match length - 4)
+ * Literal count: 255 bytes while the count goes on, if the token says 15
+ * Literals: bytes copied as they are
+ * Offset: uint16_t (distance back to the match, absent in the last sequence)
+ * Match length: 255 bytes while the length goes on, if the token says 15
+ ******************************************************/
+
+#define SDTP_COMPRESS_MIN_MATCH 4
+#define SDTP_COMPRESS_MAX_OFFSET 65535
+// Match finder entries (power of two)
+#define SDTP_COMPRESS_TABLE_SIZE 1024
+// Smaller payloads aren't worth a try
+#define SDTP_COMPRESS_MIN_SIZE 16
+// Most bytes one stream byte decodes to (a 255 length byte)
+#define SDTP_COMPRESS_MAX_RATIO 255
+
+/**
+ * Streaming decompressor.
+ * Input may arrive in pieces of any size, output is the whole payload,
+ * which doubles as the match window, so no other memory is needed.
+ * @param out Payload memory.
+ * @param out_size Payload size.
+ * @param out_pos Decoded bytes.
+ * @param state Decoder position in the sequence.
+ * @param literal Literals left to copy.
+ * @param match Match length.
+ * @param offset Match offset.
+ **/
+typedef struct {
+	uint8_t* out;
+	size_t out_size;
+	size_t out_pos;
+
+	uint8_t state;
+	size_t literal;
+	size_t match;
+	size_t offset;
+} sdtp_decompressor_t;
+
+/**
+ * Output compression state.
+ * Compression is used once the peer advertised it in its handshake.
+ * @param enabled Whether compression is advertised and used.
+ * @param storage Match finder and payload scratch.
+ * @param owns_storage Whether storage was allocated by the instance.
+ * @param compressed Number of packets sent compressed.
+ * @param skipped Number of packets sent as they are because they didn't shrink.
+ **/
+typedef struct {
+	bool enabled;
+
+	uint8_t* storage;
+	bool owns_storage;
+
+	size_t compressed;
+	size_t skipped;
+} sdtp_compression_t;
+
+/**
+ * Compression storage size for sdtp_instance_set_compression().
+ * Match finder followed by gather and output areas of one buffer each.
+ **/
+#define SDTP_COMPRESS_STORAGE_SIZE(buffer_size) \
+	(SDTP_COMPRESS_TABLE_SIZE * sizeof(uint32_t) + 2 * (size_t)(buffer_size))
+
+// INSTANCE //
+
+/**
+ * Input storage size for sdtp_instance_init().
+ * Ring memory followed by the scratch area for wrapped packet views.
+ **/
+#define SDTP_INPUT_STORAGE_SIZE(buffer_size) (2 * (size_t)(buffer_size))
+/**
+ * Output storage size for sdtp_instance_init().
+ **/
+#define SDTP_OUTPUT_STORAGE_SIZE(buffer_size) ((size_t)(buffer_size))
+
+/**
+ * Single SDTP instance.
+ * Contains I/O buffers and config.
+ * Should be created with sdtp_instance_create() or sdtp_instance_init().
+ **/
+struct sdtp_instance {
+	sdtp_config_t config;
+
+	sdtp_buffer_t* input_buffer;
+	sdtp_buffer_t* output_buffer;
+	sdtp_buffer_t buffers[2]; // Buffer structs used by sdtp_instance_init()
+	bool owns_memory;         // False for instances on caller memory
+
+	sdtp_queue_t* output_queue; // Multi-producer output path (NULL - disabled)
+	sdtp_scheduler_t scheduler; // Priority output classes
+
+	sdtp_parser_t parser;
+	uint8_t* view_scratch; // Linear copy of a body wrapped around the input buffer end
+	size_t view_scratch_size;
+
+	sdtp_dispatch_table_t dispatch;
+	sdtp_link_t link;
+
+	sdtp_reassembly_t reassembly;
+	sdtp_fragment_progress_t fragment_progress; // Output payload to resume
+	sdtp_reliable_t reliable;
+	sdtp_compression_t compression;
+
+	sdtp_header_format_t header_format; // Compact format of output frames
+	bool compact_header;                // Whether header_format is advertised and used
+
+	sdtp_clock_t clock;
+	void* clock_ctx;
+
+	sdtp_coalesce_config_t coalesce;
+	uint64_t pending_since; // Time when the oldest pending output was written
+
+	const sdtp_function_hooks* function_hooks;
+	const sdtp_function_hooks_v2* hooks_v2; // Used instead of function_hooks when set
+};
+
+// INSTANCE MANIPULATION //
+
+/**
+ * @brief Creates new SDTP instance and returns pointer to it.
+ * Config is copied.
+ **/
+sdtp_instance_t* sdtp_instance_create(const sdtp_config_t* config, const sdtp_function_hooks* gpio_hooks);
+/**
+ * @brief Initializes SDTP instance on caller memory without heap allocation.
+ * Storage is not zeroed and must outlive the instance. Config is copied.
+ * @param instance Instance to initialize.
+ * @param config SDTP configuration (buffer_size must be a power of two).
+ * @param gpio_hooks I/O hooks.
+ * @param in_storage Input memory of SDTP_INPUT_STORAGE_SIZE(buffer_size) bytes.
+ * @param out_storage Output memory of SDTP_OUTPUT_STORAGE_SIZE(buffer_size) bytes.
+ * @return Status (false - error, true - success).
+ **/
+bool sdtp_instance_init(sdtp_instance_t* instance, const sdtp_config_t* config, const sdtp_function_hooks* gpio_hooks,
+                        uint8_t* in_storage, uint8_t* out_storage);
+/**
+ * @brief Creates new SDTP instance with v2 hooks and returns pointer to it.
+ * Config is copied, hooks must outlive the instance.
+ **/
+sdtp_instance_t* sdtp_instance_create_v2(const sdtp_config_t* config, const sdtp_function_hooks_v2* hooks);
+/**
+ * @brief Initializes SDTP instance with v2 hooks on caller memory without heap allocation.
+ * Same as sdtp_instance_init() otherwise.
+ **/
+bool sdtp_instance_init_v2(sdtp_instance_t* instance, const sdtp_config_t* config, const sdtp_function_hooks_v2* hooks,
+                           uint8_t* in_storage, uint8_t* out_storage);
+/**
+ * @brief Frees and closes instance.
+ * Instances from sdtp_instance_init() are only flushed, their memory stays with the caller.
+ * Config is not freed.
+ **/
+void sdtp_instance_close(sdtp_instance_t* instance);
+/**
+ * @brief Sets instance time source.
+ * @param instance SDTP instance.
+ * @param clock Time source (NULL - sdtp_default_clock()).
+ * @param ctx Opaque pointer passed to clock.
+ **/
+void sdtp_instance_set_clock(sdtp_instance_t* instance, sdtp_clock_t clock, void* ctx);
+/**
+ * @brief Gets current time from instance time source.
+ * @return Time in microseconds.
+ **/
+uint64_t sdtp_instance_now(const sdtp_instance_t* instance);
+/**
+ * @brief Enables or disables output coalescing.
+ * Pending output is flushed when coalescing gets disabled.
+ * @param instance SDTP instance.
+ * @param coalesce Coalescing settings (NULL - disable).
+ **/
+void sdtp_instance_set_coalescing(sdtp_instance_t* instance, const sdtp_coalesce_config_t* coalesce);
+/**
+ * @brief Sets compact header format of output frames.
+ * Compact headers are used once the peer handshake advertises SDTP_FEATURE_COMPACT_HEADER,
+ * so set it before sdtp_link_connect(). Received compact frames are dropped until
+ * the feature is negotiated.
+ * @param instance SDTP instance.
+ * @param format Compact header format (NULL - full headers only).
+ * @return Status (false - invalid format, true - success).
+ **/
+bool sdtp_instance_set_header_format(sdtp_instance_t* instance, const sdtp_header_format_t* format);
+
+// PACKET MANIPULATION //
+
+/**
+ * @brief Allocates and constructs a new packet.
+ * Caller must free returned pointer.
+ * @param data Buffer with packet data.
+ * @param packet_type Type of the packet (enum sdtp_packet_type_t)
+ * @param packet_id Packet ID (must be random).
+ * @return Pointer to allocated packet struct.
+ **/
+sdtp_packet_t* sdtp_construct_packet(const char* data, sdtp_packet_type_t packet_type, uint32_t packet_id);
+/**
+ * @brief Allocates and constructs a new packet from binary data.
+ * Data may contain zero bytes. Body is copied and checksummed in a single pass.
+ * Caller must free returned pointer.
+ * @param data Buffer with packet data (may be NULL if data_len is 0).
+ * @param data_len Data length in bytes.
+ * @param packet_type Type of the packet (enum sdtp_packet_type_t)
+ * @param packet_id Packet ID (must be random).
+ * @return Pointer to allocated packet struct.
+ **/
+sdtp_packet_t* sdtp_construct_packet_bytes(const uint8_t* data, size_t data_len, sdtp_packet_type_t packet_type, uint32_t packet_id);
+/**
+ * @brief Allocates and constructs a new packet which takes ownership of data.
+ * Data must be allocated with malloc() and is freed by sdtp_packet_free().
+ * On failure ownership stays with the caller.
+ * Caller must free returned pointer.
+ * @param data Allocated buffer with packet data.
+ * @param data_len Data length in bytes.
+ * @param packet_type Type of the packet (enum sdtp_packet_type_t)
+ * @param packet_id Packet ID (must be random).
+ * @return Pointer to allocated packet struct.
+ **/
+sdtp_packet_t* sdtp_construct_packet_owned(uint8_t* data, size_t data_len, sdtp_packet_type_t packet_type, uint32_t packet_id);
+/**
+ * @brief Constructs a packet in caller-provided memory without allocations.
+ * Body is copied into body_buffer and checksummed in a single pass.
+ * Packet must not be passed to sdtp_packet_free().
+ * @param packet Packet struct to fill.
+ * @param body_buffer Buffer which receives the body.
+ * @param body_capacity Size of body_buffer.
+ * @param data Buffer with packet data (may be NULL if data_len is 0).
+ * @param data_len Data length in bytes.
+ * @param packet_type Type of the packet (enum sdtp_packet_type_t)
+ * @param packet_id Packet ID (must be random).
+ * @return Status (false - error, true - success).
+ **/
+bool sdtp_construct_packet_into(sdtp_packet_t* packet, uint8_t* body_buffer, size_t body_capacity,
+                                const uint8_t* data, size_t data_len, sdtp_packet_type_t packet_type, uint32_t packet_id);
+/**
+ * @brief Constructs a packet from several payload fragments.
+ * Fragments are gathered into the body and checksummed in a single pass.
+ * Caller must free returned pointer.
+ * @param iov Payload fragments in order.
+ * @param iov_count Number of fragments.
+ * @param packet_type Type of the packet (enum sdtp_packet_type_t)
+ * @param packet_id Packet ID (must be random).
+ * @return Pointer to allocated packet (NULL on error).
+ **/
+sdtp_packet_t* sdtp_construct_packet_iov(const sdtp_iovec_t* iov, size_t iov_count,
+                                         sdtp_packet_type_t packet_type, uint32_t packet_id);
+/**
+ * @brief Gets total length of payload fragments.
+ * @return Length in bytes (SIZE_MAX if fragments are invalid or exceed UINT32_MAX).
+ **/
+size_t sdtp_iov_length(const sdtp_iovec_t* iov, size_t iov_count);
+/**
+ * @brief Allocates a packet with an uninitialized body of data_size bytes.
+ * Header fields other than data_size are zeroed.
+ * @param allocator Allocator to use (NULL - libc).
+ * @param data_size Body size in bytes.
+ * @return Pointer to allocated packet struct.
+ **/
+sdtp_packet_t* sdtp_packet_alloc(const sdtp_allocator_t* allocator, size_t data_size);
+/**
+ * @brief Allocates and constructs a new packet using the allocator.
+ * Same as sdtp_construct_packet_bytes() but takes memory from allocator.
+ * Caller must free returned pointer.
+ **/
+sdtp_packet_t* sdtp_construct_packet_with(const sdtp_allocator_t* allocator, const uint8_t* data, size_t data_len,
+                                          sdtp_packet_type_t packet_type, uint32_t packet_id);
+/**
+ * @brief Frees packet and body data.
+ * Memory is returned to the allocator which created the packet.
+ **/
+void sdtp_packet_free(sdtp_packet_t* packet);
+
+/**
+ * @brief Serializes packet to a newly allocated buffer.
+ * Returned data is in host byte order.
+ * Caller must free returned pointer. Unavailable with SDTP_NO_MALLOC (returns NULL).
+ * @param packet Pointer to target packet.
+ * @param out_size Var which receives the size in bytes of the returned buffer.
+ * @return Pointer to allocated buffer with serialized packet.
+ **/
+uint8_t* sdtp_serialize_packet(const sdtp_packet_t* packet, size_t* out_size);
+/**
+ * @brief Serializes packet directly into free space of the buffer.
+ * SoH, header, body and EoT are written in place and the header checksum is
+ * computed while the body is copied. Nothing is written if the frame doesn't fit.
+ * @param packet Pointer to target packet.
+ * @param buffer Buffer to write.
+ * @return Written length (0 on error).
+ **/
+size_t sdtp_serialize_packet_into(const sdtp_packet_t* packet, sdtp_buffer_t* buffer);
+/**
+ * @brief Serializes payload fragments as one packet directly into free space of the buffer.
+ * Same as sdtp_serialize_packet_into() without building a packet first.
+ * @param iov Payload fragments in order.
+ * @param iov_count Number of fragments.
+ * @param packet_type Type of the packet (enum sdtp_packet_type_t)
+ * @param packet_id Packet ID (must be random).
+ * @param buffer Buffer to write.
+ * @return Written length (0 on error).
+ **/
+size_t sdtp_serialize_iov_into(const sdtp_iovec_t* iov, size_t iov_count, sdtp_packet_type_t packet_type,
+                               uint32_t packet_id, sdtp_buffer_t* buffer);
+/**
+ * @brief Serializes payload fragments as one packet with the given header format.
+ * Same as sdtp_serialize_iov_into() with a compact header when the frame fits it.
+ * @param format Compact header format (NULL - full header).
+ * @return Written length (0 on error).
+ **/
+size_t sdtp_serialize_iov_format_into(const sdtp_iovec_t* iov, size_t iov_count, sdtp_packet_type_t packet_type,
+                                      uint32_t packet_id, const sdtp_header_format_t* format, sdtp_buffer_t* buffer);
+/**
+ * @brief Serializes packet with a compact header to a newly allocated buffer.
+ * Same as sdtp_serialize_packet(), checksum is computed again because it covers the header.
+ * Caller must free returned pointer. Unavailable with SDTP_NO_MALLOC (returns NULL).
+ * @param format Compact header format (NULL or frame doesn't fit - full header).
+ **/
+uint8_t* sdtp_serialize_packet_compact(const sdtp_packet_t* packet, const sdtp_header_format_t* format,
+                                       size_t* out_size);
+/**
+ * @brief Encodes frame header without its checksum.
+ * @param head Memory of SDTP_HEAD_MAX_SIZE bytes which receives the header.
+ * @param format Compact header format (NULL or frame doesn't fit - full header).
+ * @param state Checksum state which is initialized with the header bytes it covers.
+ * @return Header size with the start byte.
+ **/
+size_t sdtp_header_begin(uint8_t* head, const sdtp_header_format_t* format, uint32_t packet_type, uint32_t packet_id,
+                         size_t data_size, sdtp_fletcher32_state_t* state);
+/**
+ * @brief Writes checksum into a header from sdtp_header_begin().
+ * @param state Checksum state after the body.
+ **/
+void sdtp_header_finish(uint8_t* head, size_t head_size, const sdtp_fletcher32_state_t* state);
+/**
+ * @brief Decodes frame header of either layout.
+ * @param data Frame bytes starting with the start byte.
+ * @param len Available bytes.
+ * @param header Var which receives the header.
+ * @param checksum_size Var which receives checksum bytes (4 for full headers).
+ * @return Header size with the start byte (0 - incomplete, SIZE_MAX - not a header).
+ **/
+size_t sdtp_header_decode(const uint8_t* data, size_t len, sdtp_packet_header_t* header, size_t* checksum_size);
+/**
+ * @brief Adds header bytes covered by the checksum to a fresh checksum state.
+ * Nothing is added for full headers, their checksum covers the body only.
+ **/
+void sdtp_header_checksum(const uint8_t* head, size_t head_size, size_t checksum_size, sdtp_fletcher32_state_t* state);
+/**
+ * @brief Folds Fletcher-32 checksum to the given width.
+ * 2 bytes - both sums mod 255 (Fletcher-16 over words), 1 byte - first sum mod 255.
+ **/
+uint32_t sdtp_checksum_fold(uint32_t checksum, size_t checksum_size);
+/**
+ * @brief Finds the first start byte of either layout.
+ * @return Pointer to it (NULL - none).
+ **/
+const uint8_t* sdtp_find_frame_start(const uint8_t* data, size_t len);
+/**
+ * @brief Deserializes raw byte data from a buffer to a newly allocated packet.
+ * Returned data is in sender host byte order.
+ * Full and compact headers are accepted, compressed packets are returned decompressed.
+ * Caller must free returned pointer.
+ * @param buffer Buffer with serialized target packet.
+ * @param buf_size Size of the buffer.
+ * @return Pointer to allocated packet struct.
+ **/
+sdtp_packet_t* sdtp_deserialize_packet(const uint8_t* buffer, size_t buf_size);
+
+// BUFFER MANIPULATION //
+
+/**
+ * @brief Creates a new buffer.
+ * Capacity is config->buffer_size rounded up to a power of two.
+ * Caller must free returned pointer.
+ * @param config Pointer to SDTP configuration.
+ * @return Pointer to allocated data buffer.
+ **/
+sdtp_buffer_t* sdtp_buffer_create(const sdtp_config_t* config);
+/**
+ * @brief Initializes buffer on caller memory without heap allocation.
+ * Capacity is storage_size rounded down to a power of two. Storage is not zeroed.
+ * @param buffer Buffer struct to initialize.
+ * @param storage Buffer memory, must outlive the buffer.
+ * @param storage_size Size of storage.
+ * @return Status (false - error, true - success).
+ **/
+bool sdtp_buffer_init(sdtp_buffer_t* buffer, uint8_t* storage, size_t storage_size);
+/**
+ * @brief Sets whether producer and consumer of the buffer run concurrently.
+ * Must be set before the producer starts.
+ **/
+void sdtp_buffer_set_concurrent(sdtp_buffer_t* buffer, bool concurrent);
+/**
+ * @brief Sets what sdtp_buffer_write() does when data doesn't fit.
+ * Concurrent buffers and buffers with pinned bytes always reject.
+ * @param policy Overflow policy.
+ * @param max_size Size limit of SDTP_OVERFLOW_GROW (only buffers created with sdtp_buffer_create() grow).
+ **/
+void sdtp_buffer_set_overflow(sdtp_buffer_t* buffer, sdtp_overflow_policy_t policy, size_t max_size);
+/**
+ * @brief Sets watermarks for backpressure.
+ * @param low Low watermark, reported once used space falls to it.
+ * @param high High watermark, reported once used space reaches it.
+ * @param callback Watermark callback (NULL - disable).
+ * @param ctx Opaque pointer passed to the callback.
+ **/
+void sdtp_buffer_set_watermarks(sdtp_buffer_t* buffer, size_t low, size_t high,
+                                sdtp_watermark_callback_t callback, void* ctx);
+/**
+ * @brief Gets the largest frame the buffer can ever hold.
+ * Capacity, or the growth limit for SDTP_OVERFLOW_GROW.
+ **/
+size_t sdtp_buffer_get_max_frame(const sdtp_buffer_t* buffer);
+/**
+ * @brief Grows an SDTP_OVERFLOW_GROW buffer until len bytes are free.
+ * Other policies, concurrent buffers and buffers with pinned bytes don't grow.
+ * @return Whether len bytes are free.
+ **/
+bool sdtp_buffer_expand(sdtp_buffer_t* buffer, size_t len);
+/**
+ * @brief Frees buffer and data.
+ * Memory of buffers from sdtp_buffer_init() is left to the caller.
+ * Caller must set buffer pointer to NULL.
+ **/
+void sdtp_buffer_free(sdtp_buffer_t* buffer);
+
+/**
+ * @brief Writes byte stream into the buffer.
+ * If there's not enough free space, the overflow policy makes room first;
+ * whatever still doesn't fit is not written (concurrent buffers write all or nothing).
+ * @param buffer Buffer to write.
+ * @param source Buffer with data to write.
+ * @param write_len Buffer length.
+ * @return Written length (short on overflow).
+ **/
+size_t sdtp_buffer_write(sdtp_buffer_t* buffer, const uint8_t* source, size_t write_len);
+/**
+ * @brief Writes byte stream into the buffer from the producer side.
+ * Lock-free, safe to call from an interrupt or a thread while another thread
+ * reads the buffer. Writes all or nothing, buffered data is never dropped.
+ * @param buffer Buffer to write.
+ * @param source Buffer with data to write.
+ * @param write_len Buffer length.
+ * @return Written length (0 if data doesn't fit).
+ **/
+size_t sdtp_buffer_push(sdtp_buffer_t* buffer, const uint8_t* source, size_t write_len);
+/**
+ * @brief Reads byte stream from the buffer.
+ * @param buffer Buffer to read.
+ * @param destination Buffer into which data will be copied.
+ * @param read_len Length to read.
+ * @param mode Reading mode (enum sdtp_read_mode_t).
+ * @return Read length.
+ **/
+size_t sdtp_buffer_read(sdtp_buffer_t* buffer, uint8_t* destination, size_t read_len, sdtp_read_mode_t mode);
+/**
+ * @brief Copies bytes into free space offset bytes past the tail.
+ * Bytes become readable only after sdtp_buffer_commit().
+ * @param buffer Buffer to write.
+ * @param offset Offset from the tail.
+ * @param source Buffer with data to write.
+ * @param write_len Buffer length.
+ * @return Staged length (0 if it doesn't fit).
+ **/
+size_t sdtp_buffer_stage(sdtp_buffer_t* buffer, size_t offset, const uint8_t* source, size_t write_len);
+/**
+ * @brief Copies bytes from the buffer without modifying it.
+ * @param buffer Buffer to read.
+ * @param offset Offset from the oldest byte.
+ * @param destination Buffer into which data will be copied.
+ * @param read_len Length to read.
+ * @return Copied length.
+ **/
+size_t sdtp_buffer_peek(const sdtp_buffer_t* buffer, size_t offset, uint8_t* destination, size_t read_len);
+
+/**
+ * @brief Clears buffer.
+ * Concurrent buffers are cleared from the consumer side by dropping received data.
+ * The input buffer isn't cleared while packet views are held, the parser starts over once it is.
+ * @param instance SDTP instance.
+ * @param buffer_type Type of buffer to clear.
+ * @return Status (false - no such buffer or views are held, true - success).
+ **/
+bool sdtp_buffer_clear(sdtp_instance_t* instance, sdtp_buffer_type_t buffer_type);
+
+/**
+ * @brief Gets used buffer space.
+ **/
+size_t sdtp_buffer_get_used_space(const sdtp_buffer_t* buffer);
+/**
+ * @brief Gets free buffer space.
+ **/
+size_t sdtp_buffer_get_free_space(const sdtp_buffer_t* buffer);
+
+/**
+ * @brief Gets contiguous readable span starting at offset bytes past the head.
+ * Data wrapped around the end of the buffer is returned by a second call with a bigger offset.
+ * @param buffer Buffer to read.
+ * @param offset Offset from the oldest byte.
+ * @param span_len Var which receives the span length.
+ * @return Pointer to the span or NULL if there's no data at offset.
+ **/
+const uint8_t* sdtp_buffer_get_read_span(const sdtp_buffer_t* buffer, size_t offset, size_t* span_len);
+/**
+ * @brief Gets contiguous readable span like sdtp_buffer_get_read_span(), but writable.
+ * For hooks which take mutable memory, bytes stay owned by the buffer.
+ **/
+uint8_t* sdtp_buffer_get_span(sdtp_buffer_t* buffer, size_t offset, size_t* span_len);
+/**
+ * @brief Releases the oldest bytes of the buffer.
+ * @return Released length.
+ **/
+size_t sdtp_buffer_consume(sdtp_buffer_t* buffer, size_t len);
+/**
+ * @brief Gets contiguous writable span at the tail.
+ * Bytes written there become readable only after sdtp_buffer_commit().
+ * @param buffer Buffer to write.
+ * @param span_len Var which receives the span length.
+ * @return Pointer to the span or NULL if the buffer is full.
+ **/
+uint8_t* sdtp_buffer_get_write_span(sdtp_buffer_t* buffer, size_t* span_len);
+/**
+ * @brief Publishes bytes written into the write span.
+ * @return Committed length.
+ **/
+size_t sdtp_buffer_commit(sdtp_buffer_t* buffer, size_t len);
+/**
+ * @brief Gets pointer to a buffer from an SDTP instance by type.
+ **/
+sdtp_buffer_t* sdtp_buffer_get_by_type(sdtp_instance_t* instance, sdtp_buffer_type_t buffer_type);
+
+// ALLOCATOR AND POOL //
+
+/**
+ * @brief Allocates memory from allocator (NULL - libc malloc).
+ * Build with SDTP_NO_MALLOC to drop libc fallback, then NULL allocator always fails.
+ **/
+void* sdtp_allocator_alloc(const sdtp_allocator_t* allocator, size_t size);
+/**
+ * @brief Frees memory to allocator (NULL - libc free).
+ **/
+void sdtp_allocator_free(const sdtp_allocator_t* allocator, void* ptr, size_t size);
+
+/**
+ * @brief Returns storage size needed by sdtp_pool_init().
+ * @param block_sizes Block size of every class.
+ * @param block_counts Block count of every class.
+ * @param class_count Number of classes (at most SDTP_POOL_MAX_CLASSES).
+ * @return Storage size in bytes (0 on error).
+ **/
+size_t sdtp_pool_storage_size(const size_t* block_sizes, const size_t* block_counts, size_t class_count);
+/**
+ * @brief Initializes pool.
+ * Block sizes are rounded up to the maximum alignment and classes are sorted by size.
+ * @param pool Pool to initialize.
+ * @param block_sizes Block size of every class.
+ * @param block_counts Block count of every class.
+ * @param class_count Number of classes (at most SDTP_POOL_MAX_CLASSES).
+ * @param storage Memory for blocks aligned to max_align_t (NULL - allocate with malloc, fails with SDTP_NO_MALLOC).
+ * @param storage_size Size of storage (see sdtp_pool_storage_size()).
+ * @param fallback Allocator used when no block fits (NULL - fail).
+ * @return Status (false - error, true - success).
+ **/
+bool sdtp_pool_init(sdtp_pool_t* pool, const size_t* block_sizes, const size_t* block_counts, size_t class_count,
+                    void* storage, size_t storage_size, const sdtp_allocator_t* fallback);
+/**
+ * @brief Frees pool storage if it was allocated by sdtp_pool_init().
+ * Every block must be returned before.
+ **/
+void sdtp_pool_destroy(sdtp_pool_t* pool);
+/**
+ * @brief Gets allocator interface of the pool.
+ * Pass it to sdtp_config_t.allocator or sdtp_packet_alloc().
+ **/
+const sdtp_allocator_t* sdtp_pool_allocator(sdtp_pool_t* pool);
+
+// OUTPUT QUEUE MANIPULATION //
+
+/**
+ * @brief Creates a new output queue.
+ * @param size Queue size in bytes, rounded up to a power of two.
+ * @param allocator Allocator for queue memory (NULL - libc malloc/free).
+ * @return Pointer to the queue (NULL on error).
+ **/
+sdtp_queue_t* sdtp_queue_create(size_t size, const sdtp_allocator_t* allocator);
+/**
+ * @brief Initializes output queue on caller memory without heap allocation.
+ * Capacity is storage_size rounded down to a power of two.
+ * @param queue Queue struct to initialize.
+ * @param storage Queue memory aligned to 4 bytes, must outlive the queue.
+ * @param storage_size Size of storage.
+ * @return Status (false - error, true - success).
+ **/
+bool sdtp_queue_init(sdtp_queue_t* queue, void* storage, size_t storage_size);
+/**
+ * @brief Frees queue and its memory.
+ * Memory of queues from sdtp_queue_init() is left to the caller.
+ **/
+void sdtp_queue_free(sdtp_queue_t* queue);
+/**
+ * @brief Attaches output queue to the instance.
+ * Must be set before producers start. Queue must outlive the instance.
+ * @param queue Queue to attach (NULL - detach).
+ **/
+void sdtp_instance_set_queue(sdtp_instance_t* instance, sdtp_queue_t* queue);
+/**
+ * @brief Serializes packet into the instance output queue.
+ * Lock-free and safe to call from many threads at once.
+ * @param instance SDTP instance with an attached queue.
+ * @param packet Packet to enqueue.
+ * @return Status (false - queue is full or packet is invalid, true - success).
+ **/
+bool sdtp_enqueue_packet(sdtp_instance_t* instance, const sdtp_packet_t* packet);
+/**
+ * @brief Moves committed frames from the output queue to the output buffer and writes them.
+ * Must be called from a single flusher thread, which owns the output buffer and the write hook.
+ * Frames are written in batches of up to the output buffer size (only when due if coalescing).
+ * Queued frames get the same treatment as sdtp_write_packet(): unless output is plain
+ * (see sdtp_output_is_plain()), they're re-encoded into their class queue with the
+ * negotiated compression and header format.
+ * @return Number of flushed frames.
+ **/
+size_t sdtp_flush_queue(sdtp_instance_t* instance);
+
+// PARSER MANIPULATION //
+
+/**
+ * @brief Resets parser to the initial state.
+ **/
+void sdtp_parser_reset(sdtp_parser_t* parser);
+/**
+ * @brief Advances parser over newly buffered bytes.
+ * Garbage before SoH is dropped from the buffer. Body bytes are checksummed as
+ * they arrive, so bytes that were already examined are never scanned again.
+ * Frames with a bad checksum or terminator are rejected, so are compact
+ * frames unless parser->compact is set.
+ * @param parser Parser state.
+ * @param buffer Buffer with received bytes.
+ * @param header Var which receives the header of the complete frame.
+ * @return true if a complete frame starts at the head of the buffer.
+ **/
+bool sdtp_parser_next(sdtp_parser_t* parser, sdtp_buffer_t* buffer, sdtp_packet_header_t* header);
+/**
+ * @brief Drops the complete frame from the buffer and resets parser.
+ **/
+void sdtp_parser_release(sdtp_parser_t* parser, sdtp_buffer_t* buffer);
+/**
+ * @brief Rejects current frame.
+ * Drops only the SoH byte, so parser resyncs on the next SoH.
+ **/
+void sdtp_parser_reject(sdtp_parser_t* parser, sdtp_buffer_t* buffer);
+/**
+ * @brief Drops bytes at the parser position.
+ * Bytes behind unreleased views are dropped together with the next view.
+ **/
+void sdtp_parser_skip(sdtp_parser_t* parser, sdtp_buffer_t* buffer, size_t len);
+/**
+ * @brief Moves parser past the complete frame without dropping it from the buffer.
+ * @return Bytes to release with sdtp_parser_unhold() (0 if no frame is ready).
+ **/
+size_t sdtp_parser_hold(sdtp_parser_t* parser);
+/**
+ * @brief Drops bytes held by the oldest view.
+ **/
+void sdtp_parser_unhold(sdtp_parser_t* parser, sdtp_buffer_t* buffer, size_t span);
+
+// INSTANCE BUFFER MANIPULATION //
+
+/**
+ * @brief Writes a single packet into output buffer.
+ * Output is written via function hook right away, or when a threshold is
+ * reached if coalescing is enabled. With priority classes the packet waits
+ * in the queue of its type class instead. Packet which doesn't fit the buffer
+ * is sent as SDTP_TYPE_FRAGMENT packets (see sdtp_instance_set_reassembly()).
+ * Fragments which fit the buffer together are output all or none. A larger payload
+ * is streamed through the buffer: if the channel gets busy on the way, writing the
+ * same packet again continues after the fragments already output.
+ * Packet is not freed.
+ * @param instance SDTP instance.
+ * @param packet Packet to write.
+ * @return Status (false - error, true - success).
+ * Packet a busy channel doesn't take stays pending and goes out with the next sdtp_flush().
+ **/
+bool sdtp_write_packet(sdtp_instance_t* instance, const sdtp_packet_t* packet);
+/**
+ * @brief Writes packet with the given priority instead of the one of its type.
+ * Priority is ignored unless priority classes are enabled.
+ * @return Status (false - error, true - success).
+ **/
+bool sdtp_write_packet_priority(sdtp_instance_t* instance, const sdtp_packet_t* packet, sdtp_priority_t priority);
+/**
+ * @brief Writes several packets into output buffer and flushes them with a single write call.
+ * Buffer is flushed early only when the next packet doesn't fit.
+ * Packets are not freed.
+ * @param instance SDTP instance.
+ * @param packets Array of packets to write.
+ * @param count Number of packets.
+ * @return Number of packets written (stops at the first packet that can't be written).
+ * If the final write call fails, only packets flushed early are counted,
+ * the rest stays in the output buffer for the next sdtp_flush(). A busy channel
+ * isn't a failure: packets it doesn't take stay pending.
+ **/
+size_t sdtp_write_packets(sdtp_instance_t* instance, const sdtp_packet_t* const* packets, size_t count);
+/**
+ * @brief Writes payload fragments as one packet.
+ * With v2 hooks, no coalescing and no pending output, fragments go to writev
+ * as they are (up to SDTP_IOV_MAX segments including header and terminator).
+ * Otherwise they are serialized straight into the output buffer, split into
+ * fragments if the packet doesn't fit it.
+ * @param instance SDTP instance.
+ * @param iov Payload fragments in order.
+ * @param iov_count Number of fragments.
+ * @param packet_type Type of the packet (enum sdtp_packet_type_t)
+ * @param packet_id Packet ID (must be random).
+ * @return Status (false - error, true - success).
+ * Fragments writev didn't take are copied to the output buffer and go out with the next sdtp_flush().
+ **/
+bool sdtp_write_packet_iov(sdtp_instance_t* instance, const sdtp_iovec_t* iov, size_t iov_count,
+                           sdtp_packet_type_t packet_type, uint32_t packet_id);
+/**
+ * @brief Serializes payload fragments as one packet without writing it.
+ * Goes through the same output path as sdtp_write_packet_iov(): compression,
+ * compact header, fragmentation and the queue of the given class.
+ * Pending output is flushed early only if there's no room.
+ * @param priority Class of the packet (ignored unless priority classes are enabled).
+ * @return Serialized length (0 - error).
+ **/
+size_t sdtp_output_packet_iov(sdtp_instance_t* instance, const sdtp_iovec_t* iov, size_t iov_count,
+                              sdtp_packet_type_t packet_type, uint32_t packet_id, sdtp_priority_t priority);
+/**
+ * @brief Whether output frames go out exactly as serialized with the full header.
+ * False once priority classes, compression or the compact header are in use.
+ **/
+bool sdtp_output_is_plain(const sdtp_instance_t* instance);
+/**
+ * @brief Reads a single packet from the input buffer and returns pointer to it.
+ * Frames are parsed incrementally: several frames per read and frames split
+ * across reads are both handled. SDTP_READ_PARTIAL drops the returned frame,
+ * SDTP_READ_FULL drops all buffered data and SDTP_READ_PEEK keeps the frame.
+ * If reassembly is enabled, fragments are consumed and the whole packet is
+ * returned once complete (SDTP_READ_PEEK returns fragments as they are).
+ * If reliable delivery is enabled, acks and duplicates are consumed and
+ * reliable packets are returned without their sequence. Compressed packets are
+ * returned decompressed, or dropped unless SDTP_FEATURE_COMPRESSION was negotiated.
+ * Caller must free returned pointer.
+ * @param instance SDTP instance.
+ * @param mode Reading mode (enum sdtp_read_mode_t).
+ * @return Pointer to allocated packet struct.
+ **/
+sdtp_packet_t* sdtp_read_packet(sdtp_instance_t* instance, sdtp_read_mode_t mode);
+/**
+ * @brief Reads every complete packet from the input buffer after a single read call.
+ * Caller must free returned pointers.
+ * @param instance SDTP instance.
+ * @param out Array which receives pointers to allocated packets.
+ * @param max Size of the out array.
+ * @return Number of packets read.
+ **/
+size_t sdtp_read_packets(sdtp_instance_t* instance, sdtp_packet_t** out, size_t max);
+/**
+ * @brief Reads a single packet from the input buffer without copying it.
+ * View body points into the input buffer; bytes are reclaimed only after
+ * sdtp_packet_view_release(), so release views as soon as possible.
+ * Fragments are returned as they are (see sdtp_reassembly_insert()).
+ * @param instance SDTP instance.
+ * @param view Var which receives the borrowed packet.
+ * @return Status (false - no complete packet, true - success).
+ **/
+bool sdtp_read_packet_view(sdtp_instance_t* instance, sdtp_packet_view_t* view);
+/**
+ * @brief Reads every complete packet as a view after a single read call.
+ * @param instance SDTP instance.
+ * @param views Array which receives borrowed packets.
+ * @param max Size of the views array.
+ * @return Number of views read.
+ **/
+size_t sdtp_read_packet_views(sdtp_instance_t* instance, sdtp_packet_view_t* views, size_t max);
+/**
+ * @brief Releases view and reclaims its input buffer bytes.
+ * View body must not be used after this call.
+ **/
+void sdtp_packet_view_release(sdtp_instance_t* instance, sdtp_packet_view_t* view);
+
+// OUTPUT PRIORITY MANIPULATION //
+
+/**
+ * @brief Enables priority output classes.
+ * Pending output is flushed first. Frames larger than a class queue can't be written.
+ * @param config Priority settings (NULL - disable).
+ * @param storage Memory of SDTP_PRIORITY_STORAGE_SIZE(queue_size) bytes (NULL - use instance allocator).
+ * @return Status (false - error, true - success).
+ **/
+bool sdtp_instance_set_priorities(sdtp_instance_t* instance, const sdtp_priority_config_t* config, uint8_t* storage);
+/**
+ * @brief Sets class of a built-in packet type.
+ * @return Status (false - error, true - success).
+ **/
+bool sdtp_set_type_priority(sdtp_instance_t* instance, sdtp_packet_type_t packet_type, sdtp_priority_t priority);
+/**
+ * @brief Returns class of a packet type (SDTP_PRIORITY_NORMAL for user-defined types).
+ **/
+sdtp_priority_t sdtp_get_type_priority(const sdtp_instance_t* instance, uint32_t packet_type);
+/**
+ * @brief Returns number of bytes waiting in class queues.
+ **/
+size_t sdtp_priority_pending(const sdtp_instance_t* instance);
+/**
+ * @brief Moves whole frames from class queues to the output buffer in scheduling order.
+ * Stops once the next frame doesn't fit. Called by sdtp_flush().
+ * @return Number of moved bytes.
+ **/
+size_t sdtp_priority_schedule(sdtp_instance_t* instance);
+
+// REASSEMBLY MANIPULATION //
+
+/**
+ * @brief Enables reassembly of fragmented packets.
+ * Payloads are allocated with the instance allocator. Disabling drops unfinished payloads.
+ * @param config Reassembly settings (NULL - disable).
+ * @return Status (false - error, true - success).
+ **/
+bool sdtp_instance_set_reassembly(sdtp_instance_t* instance, const sdtp_reassembly_config_t* config);
+/**
+ * @brief Adds a fragment to its payload.
+ * Called by sdtp_read_packet() and sdtp_dispatch() for frames with SDTP_TYPE_FRAGMENT.
+ * @param view Fragment frame.
+ * @return Whole packet once its last missing fragment arrives (must be freed), NULL otherwise.
+ * Reassembled packet has type without flags and checksum 0 (every fragment was verified).
+ **/
+sdtp_packet_t* sdtp_reassembly_insert(sdtp_instance_t* instance, const sdtp_packet_view_t* view);
+/**
+ * @brief Drops payloads older than the reassembly timeout.
+ * @return Number of dropped payloads.
+ **/
+size_t sdtp_reassembly_expire(sdtp_instance_t* instance);
+/**
+ * @brief Gets time until the oldest payload expires.
+ * @return Microseconds (0 - already expired, UINT64_MAX - nothing to expire).
+ **/
+uint64_t sdtp_reassembly_next_timeout(const sdtp_instance_t* instance);
+
+// RELIABLE DELIVERY MANIPULATION //
+
+/**
+ * @brief Enables reliable delivery.
+ * Both peers must enable it; sequences restart on every handshake.
+ * @param config Reliable delivery settings (NULL - disable, frames in flight are forgotten).
+ * @param storage Retransmit store memory of storage_size bytes (NULL - use instance allocator).
+ * @return Status (false - error, true - success).
+ **/
+bool sdtp_instance_set_reliable(sdtp_instance_t* instance, const sdtp_reliable_config_t* config, uint8_t* storage);
+/**
+ * @brief Forgets frames in flight and restarts sequences.
+ **/
+void sdtp_reliable_reset(sdtp_instance_t* instance);
+/**
+ * @brief Writes packet which is retransmitted until acknowledged.
+ * Packet is not freed.
+ * @return Status (false - error, window or retransmit store full, true - success).
+ **/
+bool sdtp_write_reliable(sdtp_instance_t* instance, const sdtp_packet_t* packet);
+/**
+ * @brief Writes payload fragments as one packet which is retransmitted until acknowledged.
+ * @return Status (false - error, window or retransmit store full, true - success).
+ **/
+bool sdtp_write_reliable_iov(sdtp_instance_t* instance, const sdtp_iovec_t* iov, size_t iov_count,
+                             sdtp_packet_type_t packet_type, uint32_t packet_id);
+/**
+ * @brief Processes a received frame.
+ * Acks release frames in flight, reliable frames are acknowledged and
+ * stripped of their sequence. Frames which arrived before a missing one are
+ * held, take them with sdtp_reliable_take_held() after the delivered frame.
+ * Called by sdtp_read_packet() and sdtp_dispatch().
+ * @param frame Received frame.
+ * @param inner Var which receives the frame to deliver (same as frame if it isn't reliable).
+ * @return Whether the frame should be delivered (false for acks, duplicates and held frames).
+ **/
+bool sdtp_reliable_receive(sdtp_instance_t* instance, const sdtp_packet_view_t* frame, sdtp_packet_view_t* inner);
+/**
+ * @brief Takes the next held frame whose turn has come.
+ * Packet must be freed with sdtp_packet_free().
+ * @return Frame without its sequence (NULL - none is due).
+ **/
+sdtp_packet_t* sdtp_reliable_take_held(sdtp_instance_t* instance);
+/**
+ * @brief Sends a pending ack and retransmits timed out frames.
+ * Should be called periodically. Called by sdtp_read_packet() and sdtp_dispatch().
+ * @return Number of retransmitted frames.
+ **/
+size_t sdtp_reliable_poll(sdtp_instance_t* instance);
+/**
+ * @brief Gets time until sdtp_reliable_poll() has work: the earliest retransmit or a pending ack.
+ * Event loops use it as their wait timeout.
+ * @return Microseconds (0 - due now, UINT64_MAX - nothing in flight).
+ **/
+uint64_t sdtp_reliable_next_timeout(const sdtp_instance_t* instance);
+/**
+ * @brief Returns number of unacknowledged frames.
+ **/
+size_t sdtp_reliable_in_flight(const sdtp_instance_t* instance);
+
+// COMPRESSION MANIPULATION //
+
+/**
+ * @brief Enables or disables output compression.
+ * Packets are compressed once the peer handshake advertises SDTP_FEATURE_COMPRESSION,
+ * so enable it before sdtp_link_connect(). Received compressed packets are decoded only
+ * after the same negotiation, before it they are dropped.
+ * @param enabled Whether to advertise and use compression.
+ * @param storage Scratch of SDTP_COMPRESS_STORAGE_SIZE(buffer_size) bytes (NULL - use instance allocator).
+ * @return Status (false - error, true - success).
+ **/
+bool sdtp_instance_set_compression(sdtp_instance_t* instance, bool enabled, uint8_t* storage);
+/**
+ * @brief Compresses data.
+ * @param source Data to compress.
+ * @param source_len Data size.
+ * @param dest Memory which receives the stream.
+ * @param dest_capacity Size of dest.
+ * @param table Match finder of SDTP_COMPRESS_TABLE_SIZE entries, contents are overwritten.
+ * @return Stream size (0 - doesn't fit into dest_capacity).
+ **/
+size_t sdtp_compress(const uint8_t* source, size_t source_len, uint8_t* dest, size_t dest_capacity, uint32_t* table);
+/**
+ * @brief Starts decompressing a payload of out_size bytes into out.
+ **/
+void sdtp_decompressor_init(sdtp_decompressor_t* decompressor, uint8_t* out, size_t out_size);
+/**
+ * @brief Decodes the next piece of the stream.
+ * @return Status (false - corrupt stream or input past its end, true - success).
+ **/
+bool sdtp_decompressor_update(sdtp_decompressor_t* decompressor, const uint8_t* input, size_t input_len);
+/**
+ * @brief Checks whether the whole payload was decoded.
+ **/
+bool sdtp_decompressor_done(const sdtp_decompressor_t* decompressor);
+/**
+ * @brief Decompresses body of a compressed frame into a new packet.
+ * Type of the packet loses SDTP_TYPE_COMPRESSED, checksum is zeroed.
+ * The size prefix is checked before anything is allocated: it may not exceed
+ * max_size or what the stream could decode to (SDTP_COMPRESS_MAX_RATIO).
+ * Caller must free returned pointer.
+ * @param allocator Allocator for the packet (NULL - libc).
+ * @param view Compressed frame.
+ * @param max_size Largest payload to accept (0 - only the stream bound).
+ * @return Pointer to allocated packet struct (NULL - corrupt stream, too large or no memory).
+ **/
+sdtp_packet_t* sdtp_decompress_packet(const sdtp_allocator_t* allocator, const sdtp_packet_view_t* view,
+                                      size_t max_size);
+
+// DISPATCH MANIPULATION //
+
+/**
+ * @brief Sets handler of a built-in packet type.
+ * @param handler Handler (NULL - remove).
+ * @return Status (false - error, true - success).
+ **/
+bool sdtp_set_handler(sdtp_instance_t* instance, sdtp_packet_type_t packet_type, sdtp_packet_handler_t handler, void* ctx);
+/**
+ * @brief Sets handler of an inclusive range of packet types.
+ * Range with the same bounds is replaced; ranges are matched in registration order.
+ * @param handler Handler (NULL - remove the range).
+ * @return Status (false - error or table full, true - success).
+ **/
+bool sdtp_set_range_handler(sdtp_instance_t* instance, uint32_t first, uint32_t last,
+                            sdtp_packet_handler_t handler, void* ctx);
+/**
+ * @brief Sets handler of packets no other handler matched.
+ * @param handler Handler (NULL - drop unmatched packets).
+ **/
+void sdtp_set_fallback_handler(sdtp_instance_t* instance, sdtp_packet_handler_t handler, void* ctx);
+/**
+ * @brief Passes a single packet to its handler.
+ * Control packets update the link state first (see sdtp_dispatch()). With reassembly
+ * enabled, fragments are kept and the whole packet is dispatched once complete.
+ * Compressed packets are dropped unless SDTP_FEATURE_COMPRESSION was negotiated.
+ * @return Whether a handler took the packet (true for kept fragments).
+ **/
+bool sdtp_dispatch_view(sdtp_instance_t* instance, const sdtp_packet_view_t* view);
+/**
+ * @brief Reads and dispatches every complete packet without copying it.
+ * Handshake marks the link up (requests are answered, replies aren't), disconnect
+ * marks it down and errors are counted, then the packet goes to its handler.
+ * Reliable packets reach handlers once, without their sequence; acks don't.
+ * Packets without a handler are dropped, so don't mix with sdtp_read_packet().
+ * @return Number of dispatched frames.
+ **/
+size_t sdtp_dispatch(sdtp_instance_t* instance);
+
+// LINK MANIPULATION //
+
+/**
+ * @brief Sends a handshake request and waits for the reply in sdtp_dispatch().
+ * Both handshakes carry the features their sender accepts. Requests are always
+ * answered, so call it again if the link stays SDTP_LINK_CONNECTING. Both ends
+ * restart reliable sequences, frames in flight are forgotten.
+ * @param packet_id ID of the handshake packet.
+ * @return Status (false - error, true - success).
+ **/
+bool sdtp_link_connect(sdtp_instance_t* instance, uint32_t packet_id);
+/**
+ * @brief Sends a disconnect and marks the link down.
+ * @param packet_id ID of the disconnect packet.
+ * @return Status (false - error, true - success).
+ **/
+bool sdtp_link_disconnect(sdtp_instance_t* instance, uint32_t packet_id);
+/**
+ * @brief Returns current link state.
+ **/
+sdtp_link_state_t sdtp_link_get_state(const sdtp_instance_t* instance);
+/**
+ * @brief Returns features both ends of an established link accept (SDTP_FEATURE_*).
+ **/
+uint32_t sdtp_link_get_features(const sdtp_instance_t* instance);
+
+// IO MANIPULATION //
+
+/**
+ * @brief Writes data from output buffer to IO output via function hook.
+ * Hook receives pointers into the buffer (two calls if the data wraps around,
+ * a single writev call with v2 hooks). Only bytes writev took are released,
+ * the rest stays in the buffer.
+ * @return Status (false - error, true - success).
+ **/
+bool sdtp_io_write(sdtp_instance_t* instance);
+/**
+ * @brief Pushes received bytes into the input buffer.
+ * Producer side of the input buffer: lock-free and safe to call from an interrupt
+ * or a reader thread while another thread reads packets (set config.concurrent_input).
+ * Input buffers that aren't concurrent grow to fit under SDTP_OVERFLOW_GROW.
+ * @param instance SDTP instance.
+ * @param data Received bytes.
+ * @param len Bytes count.
+ * @return Status (false - doesn't fit, true - success).
+ **/
+bool sdtp_io_push(sdtp_instance_t* instance, const uint8_t* data, size_t len);
+/**
+ * @brief Writes data from IO input to input buffer via function hook.
+ * v2 hooks read straight into the free space of the input buffer,
+ * nothing is read while it's full unless it may grow (SDTP_OVERFLOW_GROW). v1 reads go through sdtp_buffer_write(),
+ * so the input buffer overflow policy applies. Bytes the policy couldn't
+ * store are lost, the v1 hook can't take them back.
+ * @return Status (false - error or not everything read was stored, true - success).
+ */
+bool sdtp_io_read(sdtp_instance_t* instance);
+/**
+ * @brief Returns number of output bytes not written yet (output buffer and class queues).
+ **/
+size_t sdtp_output_pending(const sdtp_instance_t* instance);
+/**
+ * @brief Writes all pending output via function hook.
+ * Frames waiting in priority class queues go out in scheduling order.
+ * Output the channel doesn't take stays pending for the next call (see sdtp_output_pending()).
+ * @return Status (false - error, true - success or nothing to write).
+ **/
+bool sdtp_flush(sdtp_instance_t* instance);
+/**
+ * @brief Writes pending output if coalescing thresholds are reached.
+ * Call periodically so the flush deadline is honored without new writes.
+ * Without coalescing any pending output is written.
+ * @return Status (false - error, true - success or nothing due).
+ **/
+bool sdtp_flush_due(sdtp_instance_t* instance);
+
+// MISC //
+
+/**
+ * @brief Converts packet data to char.
+ * Caller must free returned and packet pointer. Unavailable with SDTP_NO_MALLOC (returns NULL).
+ * @return packet->body converted from raw bytes to null-terminated char.
+ */
+char* sdtp_get_char_data(const sdtp_packet_t* packet);
+/**
+ * @brief Converts chars to uint8_t.
+ * Caller must free returned and source buffer pointer. Unavailable with SDTP_NO_MALLOC (returns NULL).
+ * @param source Buffer with data to convert.
+ * @param data_len Converted bytes length.
+ * @return Buffer with converted data.
+ */
+uint8_t* sdtp_char_to_bytes(const char* source, size_t* data_len);
+
+/**
+ * @brief Default time source based on clock_gettime(CLOCK_MONOTONIC).
+ * Targets without a monotonic clock fall back to C11 timespec_get(), which follows
+ * wall-clock adjustments, so they should pass their own clock to sdtp_instance_set_clock().
+ * @return Monotonic time in microseconds.
+ */
+uint64_t sdtp_default_clock(void* ctx);
+
+/**
+ * @brief Selects the fastest Fletcher-32 kernel for the running CPU.
+ * Called once by sdtp_instance_create(), later calls are no-op.
+ * Build with SDTP_DISABLE_SIMD to always use the scalar kernel.
+ */
+void sdtp_checksum_init(void);
+/**
+ * @brief Selects the Fletcher-32 kernel by hand, e.g. to compare kernels.
+ * Affects every instance, so don't call it while checksums are computed.
+ * @return Status (false - kernel not built in or not supported by the CPU, true - success).
+ */
+bool sdtp_checksum_set_kernel(sdtp_checksum_kernel_t kernel);
+/**
+ * @brief Resets streaming Fletcher-32 state.
+ */
+void sdtp_fletcher32_init(sdtp_fletcher32_state_t* state);
+/**
+ * @brief Adds data to streaming Fletcher-32 state.
+ * Data may be split at any byte, odd bytes are carried to the next update.
+ */
+void sdtp_fletcher32_update(sdtp_fletcher32_state_t* state, const uint8_t* data, size_t len);
+/**
+ * @brief Returns checksum of all data added so far.
+ * State is not modified, so more data may be added later.
+ */
+uint32_t sdtp_fletcher32_final(const sdtp_fletcher32_state_t* state);
+/**
+ * @brief Calculates Fletcher-32 checksum
+ */
+uint32_t sdtp_calculate_fletcher32(const uint8_t *data, size_t len);
+/**
+ * @brief Copies data and calculates its Fletcher-32 checksum in a single pass
+ * Data is copied in small chunks which are checksummed while still in cache.
+ */
+uint32_t sdtp_copy_fletcher32(uint8_t* destination, const uint8_t* source, size_t len);
 /**
  * @brief Verifies Fletcher-32 checksum
  */
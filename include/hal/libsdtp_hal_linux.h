@@ -0,0 +1,347 @@
+// Copyright (c) 2026 bazelik
+
+#ifndef SDTP_HAL_LINUX_H
+#define SDTP_HAL_LINUX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <api/libsdtp.h>
+
+#include <pthread.h>
+
+// LINUX DRIVER //
+
+/**
+ * Linux file descriptor driver.
+ * Implements v2 hooks over non-blocking descriptors: read_into reads straight
+ * into the instance input buffer, writev passes buffer spans to writev(2) and
+ * stops once the descriptor is full. Output it didn't take stays in the output
+ * buffer, sdtp_flush() sends it when the descriptor is writable again.
+ * @param read_fd Input descriptor (-1 - none).
+ * @param write_fd Output descriptor (-1 - none).
+ * @param owns_write_fd Whether write_fd is closed separately from read_fd.
+ * @param terminal Input is a terminal: empty read means no data, not end of file.
+ * @param eof True once the input reached end of file.
+ * @param hooks Hooks for sdtp_instance_create_v2(), ctx points to this driver.
+ **/
+typedef struct {
+	int read_fd;
+	int write_fd;
+	bool owns_write_fd;
+
+	bool terminal;
+	bool eof;
+
+	sdtp_function_hooks_v2 hooks;
+} sdtp_hal_linux_t;
+
+// DRIVER MANIPULATION //
+
+/**
+ * @brief Opens serial port in raw non-blocking mode.
+ * @param driver Driver to initialize.
+ * @param path Serial device path (e.g. /dev/ttyUSB0).
+ * @param config SDTP configuration, baud_rate is mapped to the termios speed.
+ * @return Status (false - error or unsupported baud rate, true - success).
+ **/
+bool sdtp_hal_serial_open(sdtp_hal_linux_t* driver, const char* path, const sdtp_config_t* config);
+/**
+ * @brief Opens pseudo-terminal pair in raw non-blocking mode.
+ * Bytes written by one driver are read by the other one, like a null-modem cable.
+ * @param master Driver on the master side.
+ * @param slave Driver on the slave side.
+ * @return Status (false - error, true - success).
+ **/
+bool sdtp_hal_pty_open(sdtp_hal_linux_t* master, sdtp_hal_linux_t* slave);
+/**
+ * @brief Opens connected non-blocking socket pair.
+ * Bytes written by one driver are read by the other one.
+ * @param first First end.
+ * @param second Second end.
+ * @return Status (false - error, true - success).
+ **/
+bool sdtp_hal_pair_open(sdtp_hal_linux_t* first, sdtp_hal_linux_t* second);
+/**
+ * @brief Opens file replay driver.
+ * Input is a recorded byte stream, output is appended to a capture file.
+ * @param driver Driver to initialize.
+ * @param input_path Recorded input (NULL - no input).
+ * @param output_path Capture file, created or truncated (NULL - output is discarded).
+ * @return Status (false - error, true - success).
+ **/
+bool sdtp_hal_replay_open(sdtp_hal_linux_t* driver, const char* input_path, const char* output_path);
+/**
+ * @brief Closes driver descriptors.
+ **/
+void sdtp_hal_close(sdtp_hal_linux_t* driver);
+/**
+ * @brief Gets v2 hooks of the driver.
+ * Pass them to sdtp_instance_create_v2(). Driver must outlive the instance.
+ **/
+const sdtp_function_hooks_v2* sdtp_hal_hooks(const sdtp_hal_linux_t* driver);
+
+// REACTOR //
+
+#define SDTP_REACTOR_MAX_EVENTS 64
+
+struct sdtp_gateway_worker;
+
+/**
+ * Called for every verified packet of a link.
+ * View is released after the callback returns.
+ **/
+typedef void (*sdtp_reactor_packet_callback_t)(sdtp_instance_t* instance, const sdtp_packet_view_t* view, void* ctx);
+/**
+ * Called once when the link input reaches end of file or fails.
+ * Link is already removed from the reactor.
+ **/
+typedef void (*sdtp_reactor_close_callback_t)(sdtp_instance_t* instance, void* ctx);
+
+/**
+ * Link registered in a reactor.
+ * Memory is owned by the caller and must stay valid while the link is registered.
+ * @param instance Instance created with the driver hooks.
+ * @param driver Driver with a pollable read descriptor (write descriptor must be the same or always writable).
+ * @param on_packet Packet callback (NULL - instance dispatch table, see sdtp_dispatch()).
+ * @param on_close Close callback (NULL - none).
+ * @param ctx Opaque pointer passed to callbacks.
+ * @param reactor Reactor of the link (set by sdtp_reactor_add()).
+ * @param write_armed Whether writable events are requested.
+ * @param registered Whether the link is in the reactor.
+ * @param next Next link of the reactor (set by sdtp_reactor_add()).
+ * @param worker Gateway worker which serves the link (set by sdtp_gateway_add()).
+ **/
+typedef struct sdtp_reactor_link {
+	sdtp_instance_t* instance;
+	sdtp_hal_linux_t* driver;
+
+	sdtp_reactor_packet_callback_t on_packet;
+	sdtp_reactor_close_callback_t on_close;
+	void* ctx;
+
+	struct sdtp_reactor* reactor;
+	bool write_armed;
+	bool registered;
+
+	struct sdtp_reactor_link* next;
+
+	struct sdtp_gateway_worker* worker;
+} sdtp_reactor_link_t;
+
+/**
+ * epoll event loop over many links.
+ * Only links with readable input are read and parsed. Output left pending
+ * (e.g. by coalescing or a peer which reads slowly) is flushed when the link
+ * becomes writable, writable events are requested only while it's pending.
+ * A link whose peer stops reading never blocks the other links.
+ * Timers of every link (reliable retransmits and acks, reassembly timeouts)
+ * run on each iteration, idle links included, and bound the wait.
+ * Reactor is not thread-safe: run one reactor per thread.
+ * @param epoll_fd epoll descriptor.
+ * @param link_count Number of registered links.
+ * @param links Registered links.
+ **/
+typedef struct sdtp_reactor {
+	int epoll_fd;
+	size_t link_count;
+
+	sdtp_reactor_link_t* links;
+} sdtp_reactor_t;
+
+// REACTOR MANIPULATION //
+
+/**
+ * @brief Initializes reactor.
+ * @return Status (false - error, true - success).
+ **/
+bool sdtp_reactor_init(sdtp_reactor_t* reactor);
+/**
+ * @brief Closes reactor. Links are not closed.
+ **/
+void sdtp_reactor_close(sdtp_reactor_t* reactor);
+/**
+ * @brief Registers link by its driver read descriptor.
+ * @return Status (false - error, true - success).
+ **/
+bool sdtp_reactor_add(sdtp_reactor_t* reactor, sdtp_reactor_link_t* link);
+/**
+ * @brief Unregisters link.
+ **/
+void sdtp_reactor_remove(sdtp_reactor_t* reactor, sdtp_reactor_link_t* link);
+/**
+ * @brief Requests writable event if the link has pending output.
+ * Call after writing packets outside of the reactor callbacks.
+ * @return Status (false - error, true - success).
+ **/
+bool sdtp_reactor_update(sdtp_reactor_t* reactor, sdtp_reactor_link_t* link);
+/**
+ * @brief Waits for ready links and services them.
+ * Readable links are drained and every complete packet is passed to on_packet,
+ * writable links with pending output are flushed, then timers of every link run.
+ * Wait is cut short by the earliest timer of any link.
+ * @param reactor Reactor to run.
+ * @param timeout_ms Wait timeout (-1 - infinite, 0 - don't wait).
+ * @return Number of serviced links (-1 on error).
+ **/
+int sdtp_reactor_run_once(sdtp_reactor_t* reactor, int timeout_ms);
+
+// GATEWAY //
+
+#define SDTP_GATEWAY_POLL_MS 10
+
+/**
+ * Gateway configuration.
+ * @param worker_count Number of worker threads.
+ * @param pin_cpus Pin worker i to CPU (first_cpu + i).
+ * @param first_cpu CPU of the first worker.
+ * @param handoff_size Handoff queue slots per worker (rounded up to a power of two).
+ * @param pool_block_sizes Packet pool block sizes of every worker (NULL - packets use libc).
+ * @param pool_block_counts Packet pool block counts of every worker.
+ * @param pool_class_count Number of packet pool classes.
+ **/
+typedef struct {
+	size_t worker_count;
+
+	bool pin_cpus;
+	size_t first_cpu;
+
+	size_t handoff_size;
+
+	const size_t* pool_block_sizes;
+	const size_t* pool_block_counts;
+	size_t pool_class_count;
+} sdtp_gateway_config_t;
+
+/**
+ * Decoded packet handed off to the application.
+ * @param link Link which received the packet.
+ * @param packet Packet owned by the worker pool, return it with sdtp_gateway_release().
+ **/
+typedef struct {
+	sdtp_reactor_link_t* link;
+	sdtp_packet_t* packet;
+} sdtp_gateway_item_t;
+
+/**
+ * Lock-free single-producer single-consumer queue of handoff items.
+ * @param slots Item memory.
+ * @param mask Index mask (slot count - 1).
+ * @param head Consumer position.
+ * @param tail Producer position.
+ **/
+typedef struct {
+	sdtp_gateway_item_t* slots;
+	size_t mask;
+
+	sdtp_atomic_size_t head;
+	sdtp_atomic_size_t tail;
+} sdtp_handoff_t;
+
+/**
+ * Worker statistics snapshot.
+ * @param links Links served by the worker.
+ * @param packets Packets handed off.
+ * @param bytes Body bytes handed off.
+ * @param dropped Packets dropped because the handoff queue or the pool was full.
+ **/
+typedef struct {
+	size_t links;
+	size_t packets;
+	size_t bytes;
+	size_t dropped;
+} sdtp_gateway_stats_t;
+
+struct sdtp_gateway;
+
+/**
+ * Gateway worker.
+ * Owns its reactor, packet pool and counters; nothing of it is written by other threads
+ * except the two queues, each of which has a single producer and a single consumer.
+ **/
+typedef struct sdtp_gateway_worker {
+	struct sdtp_gateway* gateway;
+	size_t index;
+	pthread_t thread;
+	bool started;
+
+	sdtp_reactor_t reactor;
+	sdtp_pool_t pool;
+	const sdtp_allocator_t* allocator; // Pool allocator (NULL - libc)
+
+	sdtp_handoff_t handoff; // Worker to application
+	sdtp_handoff_t returns; // Application to worker, packets to free
+
+	sdtp_atomic_size_t packets;
+	sdtp_atomic_size_t bytes;
+	sdtp_atomic_size_t dropped;
+} sdtp_gateway_worker_t;
+
+/**
+ * Sharded gateway.
+ * Links are spread over worker threads, each running its own reactor.
+ * @param config Gateway configuration.
+ * @param workers Worker array.
+ * @param running Nonzero while workers run.
+ **/
+typedef struct sdtp_gateway {
+	sdtp_gateway_config_t config;
+	sdtp_gateway_worker_t* workers;
+
+	sdtp_atomic_size_t running;
+} sdtp_gateway_t;
+
+// GATEWAY MANIPULATION //
+
+/**
+ * @brief Initializes gateway and its workers. Threads are not started yet.
+ * @return Status (false - error, true - success).
+ **/
+bool sdtp_gateway_init(sdtp_gateway_t* gateway, const sdtp_gateway_config_t* config);
+/**
+ * @brief Stops workers and frees gateway memory. Links are not closed.
+ **/
+void sdtp_gateway_destroy(sdtp_gateway_t* gateway);
+/**
+ * @brief Assigns link to the worker with the fewest links.
+ * Must be called before sdtp_gateway_start(). Gateway takes link on_packet and ctx,
+ * so both must be NULL: packets go to sdtp_gateway_poll() instead.
+ * @return Worker index (-1 on error or if the link has its own callback or ctx).
+ **/
+int sdtp_gateway_add(sdtp_gateway_t* gateway, sdtp_reactor_link_t* link);
+/**
+ * @brief Starts worker threads.
+ * @return Status (false - error, true - success).
+ **/
+bool sdtp_gateway_start(sdtp_gateway_t* gateway);
+/**
+ * @brief Stops and joins worker threads.
+ **/
+void sdtp_gateway_stop(sdtp_gateway_t* gateway);
+/**
+ * @brief Takes decoded packets of a worker.
+ * Each worker queue must be polled by a single consumer thread.
+ * @param gateway Gateway.
+ * @param worker Worker index.
+ * @param items Array which receives items.
+ * @param max Array size.
+ * @return Number of items.
+ **/
+size_t sdtp_gateway_poll(sdtp_gateway_t* gateway, size_t worker, sdtp_gateway_item_t* items, size_t max);
+/**
+ * @brief Returns packet to the pool of the worker which decoded it.
+ * Must be called by the consumer of that worker. Waits while the return queue is full.
+ **/
+void sdtp_gateway_release(sdtp_gateway_t* gateway, size_t worker, sdtp_packet_t* packet);
+/**
+ * @brief Gets worker statistics.
+ * @return Status (false - no such worker, true - success).
+ **/
+bool sdtp_gateway_get_stats(const sdtp_gateway_t* gateway, size_t worker, sdtp_gateway_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //SDTP_HAL_LINUX_H
@@ -4,14 +4,38 @@
 #define LIBSDTP_SHARED_H
 
 #include <stdint.h>
+#include <stddef.h>
 
 /**
  * @brief Struct with pointers to functions.
  * Used to read/write from/to buffers.
+ * Buffer returned by read is freed with libc free(), unless built with SDTP_NO_MALLOC,
+ * then it stays owned by the hook.
  **/
 typedef struct {
 	void     (*write)(uint8_t* buffer, size_t write_len); // Writes a buffer to the output channel.
 	uint8_t* (*read)(size_t* read_len);                   // Returns a buffer from the input channel. Writes read length to read_len.
 } sdtp_function_hooks;
 
+/**
+ * @brief Scatter-gather segment.
+ **/
+typedef struct {
+	const uint8_t* base; // Segment start.
+	size_t len;          // Segment length.
+} sdtp_iovec_t;
+
+/**
+ * @brief Struct with pointers to functions, version 2.
+ * Library owns all memory: read fills library buffers directly and write
+ * receives segments without concatenation. ctx is passed to every call,
+ * so one driver can serve many instances. Bytes writev didn't take stay
+ * in the output buffer until the next flush.
+ **/
+typedef struct {
+	void* ctx;                                                         // Opaque driver context.
+	size_t (*read_into)(void* ctx, uint8_t* buffer, size_t capacity);  // Fills up to capacity bytes. Returns read length.
+	size_t (*writev)(void* ctx, const sdtp_iovec_t* iov, size_t count); // Writes segments to the output channel in order. Returns written length, less than the total if the channel is busy.
+} sdtp_function_hooks_v2;
+
 #endif //LIBSDTP_SHARED_H
\ No newline at end of file
@@ -0,0 +1,32 @@
+// Copyright (c) 2026 bazelik
+
+#include <api/libsdtp.h>
+
+#ifndef SDTP_NO_MALLOC
+#include <stdlib.h>
+#endif
+
+void* sdtp_allocator_alloc(const sdtp_allocator_t* allocator, const size_t size) {
+	if (size == 0) return NULL;
+
+	if (!allocator || !allocator->alloc) {
+#ifdef SDTP_NO_MALLOC
+		return NULL;
+#else
+		return malloc(size);
+#endif
+	}
+	return allocator->alloc(allocator->ctx, size);
+}
+
+void sdtp_allocator_free(const sdtp_allocator_t* allocator, void* ptr, const size_t size) {
+	if (!ptr) return;
+
+	if (!allocator || !allocator->free) {
+#ifndef SDTP_NO_MALLOC
+		free(ptr);
+#endif
+		return;
+	}
+	allocator->free(allocator->ctx, ptr, size);
+}
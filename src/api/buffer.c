@@ -2,68 +2,305 @@
 
 #include <api/libsdtp.h>
 
-#include <stdlib.h>
 #include <string.h>
 
+// Positions are published with release and observed with acquire, so bytes
+// written before a position update are visible to the other side
+static size_t sdtp_buffer_load_head(const sdtp_buffer_t* buffer) {
+	return atomic_load_explicit(&buffer->head, memory_order_acquire);
+}
+
+static size_t sdtp_buffer_load_tail(const sdtp_buffer_t* buffer) {
+	return atomic_load_explicit(&buffer->tail, memory_order_acquire);
+}
+
+static void sdtp_buffer_store_head(sdtp_buffer_t* buffer, const size_t head) {
+	atomic_store_explicit(&buffer->head, head, memory_order_release);
+}
+
+static void sdtp_buffer_store_tail(sdtp_buffer_t* buffer, const size_t tail) {
+	atomic_store_explicit(&buffer->tail, tail, memory_order_release);
+}
+
+// Reports watermark crossings, each only once until the other one is crossed
+static void sdtp_buffer_check_level(sdtp_buffer_t* buffer) {
+	if (!buffer->on_watermark) return;
+
+	const size_t used_space = sdtp_buffer_get_used_space(buffer);
+	if (used_space >= buffer->high_watermark) {
+		if (!atomic_load_explicit(&buffer->above_high, memory_order_relaxed) &&
+		    atomic_exchange_explicit(&buffer->above_high, 1, memory_order_relaxed) == 0) {
+			buffer->on_watermark(buffer, true, buffer->watermark_ctx);
+		}
+	} else if (used_space <= buffer->low_watermark) {
+		if (atomic_load_explicit(&buffer->above_high, memory_order_relaxed) &&
+		    atomic_exchange_explicit(&buffer->above_high, 0, memory_order_relaxed) == 1) {
+			buffer->on_watermark(buffer, false, buffer->watermark_ctx);
+		}
+	}
+}
+
+// Sets fields shared by create and init
+static void sdtp_buffer_setup(sdtp_buffer_t* buffer, uint8_t* data, const size_t capacity) {
+	buffer->data = data;
+	buffer->concurrent = false;
+
+	// Init variables
+	buffer->size = capacity;
+	buffer->mask = capacity - 1;
+	atomic_init(&buffer->head, 0);
+	atomic_init(&buffer->tail, 0);
+
+	// Wipe on overflow like before policies existed, no watermarks
+	buffer->overflow = SDTP_OVERFLOW_WIPE;
+	buffer->max_size = capacity;
+	buffer->pinned = 0;
+	buffer->dropped = 0;
+	buffer->low_watermark = 0;
+	buffer->high_watermark = 0;
+	buffer->on_watermark = NULL;
+	buffer->watermark_ctx = NULL;
+	atomic_init(&buffer->above_high, 0);
+}
+
+// Rounds size up to the nearest power of two (0 on overflow)
+static size_t sdtp_buffer_round_capacity(const size_t size) {
+	size_t capacity = 1;
+
+	while (capacity < size) {
+		if (capacity > SIZE_MAX / 2) return 0;
+		capacity <<= 1;
+	}
+
+	return capacity;
+}
+
 sdtp_buffer_t* sdtp_buffer_create(const sdtp_config_t* config) {
 	if (config->buffer_size <= 0) return NULL;
 
+	const size_t capacity = sdtp_buffer_round_capacity(config->buffer_size);
+	if (capacity == 0) return NULL;
+
 	// Allocate buffer struct
-	sdtp_buffer_t* buffer = (sdtp_buffer_t*)malloc(sizeof(sdtp_buffer_t));
+	sdtp_buffer_t* buffer = (sdtp_buffer_t*)sdtp_allocator_alloc(config->allocator, sizeof(sdtp_buffer_t));
 	if (!buffer) {
 		return NULL;
 	}
 
 	// Allocate data
-	buffer->data = (uint8_t*)calloc(config->buffer_size, sizeof(uint8_t));
+	buffer->data = (uint8_t*)sdtp_allocator_alloc(config->allocator, capacity);
 	if (!buffer->data) {
-		free(buffer);
+		sdtp_allocator_free(config->allocator, buffer, sizeof(sdtp_buffer_t));
 		return NULL;
 	}
+	buffer->allocator = config->allocator;
+	buffer->owns_memory = true;
+	sdtp_buffer_setup(buffer, buffer->data, capacity);
 
-	buffer->tail = buffer->data;
+	return buffer;
+}
 
-	// Init variables
-	buffer->size = config->buffer_size;
+bool sdtp_buffer_init(sdtp_buffer_t* buffer, uint8_t* storage, const size_t storage_size) {
+	if (!buffer || !storage || storage_size == 0) return false;
 
-	return buffer;
+	// Largest power of two which fits storage
+	size_t capacity = 1;
+	while (capacity <= storage_size / 2) capacity <<= 1;
+
+	// Storage is used as is, stale bytes are never read
+	buffer->allocator = NULL;
+	buffer->owns_memory = false;
+	sdtp_buffer_setup(buffer, storage, capacity);
+
+	return true;
+}
+
+void sdtp_buffer_set_concurrent(sdtp_buffer_t* buffer, const bool concurrent) {
+	if (!buffer) return;
+
+	buffer->concurrent = concurrent;
+}
+
+void sdtp_buffer_set_overflow(sdtp_buffer_t* buffer, const sdtp_overflow_policy_t policy, const size_t max_size) {
+	if (!buffer) return;
+
+	buffer->overflow = policy;
+	buffer->max_size = max_size;
+}
+
+void sdtp_buffer_set_watermarks(sdtp_buffer_t* buffer, const size_t low, const size_t high,
+                                const sdtp_watermark_callback_t callback, void* ctx) {
+	if (!buffer) return;
+
+	buffer->low_watermark = low;
+	buffer->high_watermark = high;
+	buffer->on_watermark = callback;
+	buffer->watermark_ctx = ctx;
+	atomic_store_explicit(&buffer->above_high, 0, memory_order_relaxed);
+
+	sdtp_buffer_check_level(buffer);
 }
 
 void sdtp_buffer_free(sdtp_buffer_t* buffer) {
 	if (!buffer) return;
 
+	// Caller memory
+	if (!buffer->owns_memory) {
+		buffer->data = NULL;
+		return;
+	}
+
+	const sdtp_allocator_t* allocator = buffer->allocator;
+
 	// Free data
-	if (buffer->data) free(buffer->data);
+	if (buffer->data) sdtp_allocator_free(allocator, buffer->data, buffer->size);
 
 	// Set pointers to null
-	buffer->tail = NULL;
 	buffer->data = NULL;
 
 	// Free buffer struct
-	free(buffer);
+	sdtp_allocator_free(allocator, buffer, sizeof(sdtp_buffer_t));
+}
+
+// Drops whole frames from the head until len bytes are free
+static void sdtp_buffer_drop_frames(sdtp_buffer_t* buffer, const size_t len) {
+	while (sdtp_buffer_get_free_space(buffer) < len) {
+		const size_t used_space = sdtp_buffer_get_used_space(buffer);
+		if (used_space == 0) return;
+
+		uint8_t head[SDTP_HEAD_MAX_SIZE];
+		const size_t head_len = sdtp_buffer_peek(buffer, 0, head, sizeof(head));
+
+		size_t drop = 1;
+		if (head[0] == SDTP_START_OF_HEADER || head[0] == SDTP_START_OF_COMPACT) {
+			// Frame still being received is never cut
+			sdtp_packet_header_t header;
+			size_t checksum_size = 0;
+			const size_t head_size = sdtp_header_decode(head, head_len, &header, &checksum_size);
+			if (head_size == 0) return;
+
+			if (head_size != SIZE_MAX && header.data_size <= sdtp_buffer_get_max_frame(buffer) - head_size - 1) {
+				if (head_size + header.data_size + 1 > used_space) return;
+				drop = head_size + header.data_size + 1;
+			}
+		} else {
+			// Bytes before the next start byte aren't a frame
+			while (drop < used_space) {
+				size_t span_len = 0;
+				const uint8_t* span = sdtp_buffer_get_read_span(buffer, drop, &span_len);
+				const uint8_t* soh = sdtp_find_frame_start(span, span_len);
+				if (soh) {
+					drop += (size_t)(soh - span);
+					break;
+				}
+				drop += span_len;
+			}
+		}
+
+		sdtp_buffer_consume(buffer, drop);
+		buffer->dropped += drop;
+	}
+}
+
+// Largest capacity growth may reach
+static size_t sdtp_buffer_grow_limit(const sdtp_buffer_t* buffer) {
+	if (!buffer->owns_memory || buffer->max_size == 0) return buffer->size;
+
+	// Largest power of two within the limit
+	size_t limit = 1;
+	while (limit <= buffer->max_size / 2) limit <<= 1;
+
+	return limit > buffer->size ? limit : buffer->size;
+}
+
+// Moves data to larger memory, up to max_size
+static void sdtp_buffer_grow(sdtp_buffer_t* buffer, const size_t required) {
+	const size_t limit = sdtp_buffer_grow_limit(buffer);
+
+	size_t capacity = sdtp_buffer_round_capacity(required);
+	if (capacity == 0 || capacity > limit) capacity = limit;
+	if (capacity <= buffer->size) return;
+
+	uint8_t* data = (uint8_t*)sdtp_allocator_alloc(buffer->allocator, capacity);
+	if (!data) return;
+
+	// Data starts at the beginning of the new memory, positions relative to the head stay valid
+	const size_t used_space = sdtp_buffer_peek(buffer, 0, data, sdtp_buffer_get_used_space(buffer));
+	sdtp_allocator_free(buffer->allocator, buffer->data, buffer->size);
+
+	buffer->data = data;
+	buffer->size = capacity;
+	buffer->mask = capacity - 1;
+	sdtp_buffer_store_head(buffer, 0);
+	sdtp_buffer_store_tail(buffer, used_space);
+}
+
+size_t sdtp_buffer_get_max_frame(const sdtp_buffer_t* buffer) {
+	if (!buffer) return 0;
+
+	return buffer->overflow == SDTP_OVERFLOW_GROW ? sdtp_buffer_grow_limit(buffer) : buffer->size;
+}
+
+bool sdtp_buffer_expand(sdtp_buffer_t* buffer, const size_t len) {
+	if (!buffer) return false;
+
+	// Views point into the current memory
+	if (len > sdtp_buffer_get_free_space(buffer) && buffer->overflow == SDTP_OVERFLOW_GROW &&
+	    !buffer->concurrent && buffer->pinned == 0) {
+		sdtp_buffer_grow(buffer, sdtp_buffer_get_used_space(buffer) + len);
+	}
+
+	return len <= sdtp_buffer_get_free_space(buffer);
 }
 
 size_t sdtp_buffer_write(sdtp_buffer_t* buffer, const uint8_t* source, const size_t write_len) {
 	if (!buffer || !source || write_len == 0) return 0;
 
-	const size_t used_space = sdtp_buffer_get_used_space(buffer);
-	const size_t free_space = buffer->size - used_space;
+	// Head belongs to the consumer, so concurrent buffers only reject
+	if (buffer->concurrent) return sdtp_buffer_push(buffer, source, write_len);
+
+	// Make room as the policy allows, bytes held by views stay in place
+	if (write_len > sdtp_buffer_get_free_space(buffer)) {
+		switch (buffer->overflow) {
+			case SDTP_OVERFLOW_WIPE:
+				if (write_len > buffer->size) return 0;
+				if (buffer->pinned == 0) {
+					buffer->dropped += sdtp_buffer_get_used_space(buffer);
+					sdtp_buffer_store_head(buffer, 0);
+					sdtp_buffer_store_tail(buffer, 0);
+				}
+				break;
+
+			case SDTP_OVERFLOW_DROP_OLDEST:
+				if (buffer->pinned == 0) sdtp_buffer_drop_frames(buffer, write_len);
+				break;
+
+			case SDTP_OVERFLOW_GROW:
+				sdtp_buffer_expand(buffer, write_len);
+				break;
+
+			default:
+				break;
+		}
+	}
 
-	// If there's not enough free space, clear existing buffer contents
-	if (write_len > free_space) {
-		// Clear buffer
-		memset(buffer->data, 0, used_space);
+	// Copy what fits and publish
+	const size_t free_space = sdtp_buffer_get_free_space(buffer);
+	const size_t len = write_len < free_space ? write_len : free_space;
+	if (len == 0) return 0;
 
-		// Write new data
-		memcpy(buffer->data, source, write_len);
-		buffer->tail = buffer->data + write_len;
+	sdtp_buffer_stage(buffer, 0, source, len);
+	sdtp_buffer_commit(buffer, len);
 
-		return write_len;
-	}
+	return len;
+}
+
+size_t sdtp_buffer_push(sdtp_buffer_t* buffer, const uint8_t* source, const size_t write_len) {
+	if (!buffer || !source || write_len == 0) return 0;
 
-	// If there's enough space append at end
-	memcpy(buffer->tail, source, write_len);
-	buffer->tail += write_len;
+	// Copy, then publish the bytes with the new tail
+	if (sdtp_buffer_stage(buffer, 0, source, write_len) != write_len) return 0;
+	sdtp_buffer_commit(buffer, write_len);
 
 	return write_len;
 }
@@ -78,22 +315,18 @@ size_t sdtp_buffer_read(sdtp_buffer_t* buffer, uint8_t* destination, size_t read
 	if (read_len > used_space) read_len = used_space;
 
 	// Copy data
-	memcpy(destination, buffer->data, read_len);
+	read_len = sdtp_buffer_peek(buffer, 0, destination, read_len);
 
 	// Handle different read modes
 	switch (mode) {
 		case SDTP_READ_FULL:
-			// Clear buffer
-			memset(buffer->data, 0, buffer->size);
-			buffer->tail = buffer->data;
+			// Drop everything
+			sdtp_buffer_consume(buffer, used_space);
 			break;
 
 		case SDTP_READ_PARTIAL:
-			// Shift data
-			if (read_len < used_space) {
-				memmove(buffer->data, buffer->data + read_len, used_space - read_len);
-			}
-			buffer->tail -= read_len;
+			// Drop read data
+			sdtp_buffer_consume(buffer, read_len);
 			break;
 
 		default:
@@ -103,23 +336,158 @@ size_t sdtp_buffer_read(sdtp_buffer_t* buffer, uint8_t* destination, size_t read
 	return read_len;
 }
 
-void sdtp_buffer_clear(sdtp_instance_t* instance, const sdtp_buffer_type_t buffer_type) {
-	if (!instance) return;
+size_t sdtp_buffer_stage(sdtp_buffer_t* buffer, const size_t offset, const uint8_t* source, const size_t write_len) {
+	if (!buffer || !source || write_len == 0) return 0;
+
+	const size_t free_space = sdtp_buffer_get_free_space(buffer);
+	if (offset > free_space || write_len > free_space - offset) return 0;
+
+	// Copy up to the end of the memory, then wrap to the start
+	const size_t start = (atomic_load_explicit(&buffer->tail, memory_order_relaxed) + offset) & buffer->mask;
+	const size_t first = write_len < buffer->size - start ? write_len : buffer->size - start;
+
+	memcpy(buffer->data + start, source, first);
+	if (first < write_len) {
+		memcpy(buffer->data, source + first, write_len - first);
+	}
+
+	return write_len;
+}
+
+size_t sdtp_buffer_peek(const sdtp_buffer_t* buffer, const size_t offset, uint8_t* destination, const size_t read_len) {
+	if (!buffer || !destination) return 0;
+
+	// Copy at most two spans because of wrap-around
+	size_t copied = 0;
+	while (copied < read_len) {
+		size_t span_len = 0;
+		const uint8_t* span = sdtp_buffer_get_read_span(buffer, offset + copied, &span_len);
+		if (!span) break;
+
+		if (span_len > read_len - copied) span_len = read_len - copied;
+		memcpy(destination + copied, span, span_len);
+		copied += span_len;
+	}
+
+	return copied;
+}
+
+bool sdtp_buffer_clear(sdtp_instance_t* instance, const sdtp_buffer_type_t buffer_type) {
+	if (!instance) return false;
 
 	sdtp_buffer_t* buffer = sdtp_buffer_get_by_type(instance, buffer_type);
-	if (!buffer) return;
+	if (!buffer) return false;
 
-	const size_t used = sdtp_buffer_get_used_space(buffer);
-	if (used == 0) return;
+	// Views point into the buffer and are released against the parser
+	const bool input = buffer == instance->input_buffer;
+	if (buffer->pinned > 0 || (input && instance->parser.views > 0)) return false;
 
 	// Remove used space
-	memset(buffer->data, 0, used);
-	buffer->tail = buffer->data;
+	if (buffer->concurrent) {
+		sdtp_buffer_store_head(buffer, sdtp_buffer_load_tail(buffer));
+	} else {
+		sdtp_buffer_store_head(buffer, 0);
+		sdtp_buffer_store_tail(buffer, 0);
+	}
+	if (input) sdtp_parser_reset(&instance->parser);
+
+	sdtp_buffer_check_level(buffer);
+
+	return true;
 }
 
 size_t sdtp_buffer_get_used_space(const sdtp_buffer_t* buffer) {
 	if (!buffer || !buffer->data) return 0;
-	return (size_t)(buffer->tail - buffer->data);
+
+	// Head first: tail is never behind a later head
+	const size_t head = sdtp_buffer_load_head(buffer);
+	return sdtp_buffer_load_tail(buffer) - head;
+}
+
+size_t sdtp_buffer_get_free_space(const sdtp_buffer_t* buffer) {
+	if (!buffer || !buffer->data) return 0;
+
+	// Positions may move between the loads, never report more than the capacity as used
+	const size_t used_space = sdtp_buffer_get_used_space(buffer);
+	return used_space < buffer->size ? buffer->size - used_space : 0;
+}
+
+// Index of the readable span at offset (false - no data there)
+static bool sdtp_buffer_span_at(const sdtp_buffer_t* buffer, const size_t offset, size_t* start, size_t* span_len) {
+	*span_len = 0;
+
+	const size_t used_space = sdtp_buffer_get_used_space(buffer);
+	if (offset >= used_space) return false;
+
+	// Span ends either at the tail or at the end of the memory
+	*start = (atomic_load_explicit(&buffer->head, memory_order_relaxed) + offset) & buffer->mask;
+	const size_t available = used_space - offset;
+	const size_t to_end = buffer->size - *start;
+
+	*span_len = available < to_end ? available : to_end;
+	return true;
+}
+
+const uint8_t* sdtp_buffer_get_read_span(const sdtp_buffer_t* buffer, const size_t offset, size_t* span_len) {
+	if (!buffer || !span_len) return NULL;
+
+	size_t start = 0;
+	return sdtp_buffer_span_at(buffer, offset, &start, span_len) ? buffer->data + start : NULL;
+}
+
+uint8_t* sdtp_buffer_get_span(sdtp_buffer_t* buffer, const size_t offset, size_t* span_len) {
+	if (!buffer || !span_len) return NULL;
+
+	size_t start = 0;
+	return sdtp_buffer_span_at(buffer, offset, &start, span_len) ? buffer->data + start : NULL;
+}
+
+size_t sdtp_buffer_consume(sdtp_buffer_t* buffer, size_t len) {
+	if (!buffer) return 0;
+
+	const size_t used_space = sdtp_buffer_get_used_space(buffer);
+	if (len > used_space) len = used_space;
+
+	const size_t head = atomic_load_explicit(&buffer->head, memory_order_relaxed) + len;
+	sdtp_buffer_store_head(buffer, head);
+
+	// Rewind empty buffer so the next write starts contiguous (tail belongs to a concurrent producer)
+	if (!buffer->concurrent && head == sdtp_buffer_load_tail(buffer)) {
+		sdtp_buffer_store_head(buffer, 0);
+		sdtp_buffer_store_tail(buffer, 0);
+	}
+
+	sdtp_buffer_check_level(buffer);
+
+	return len;
+}
+
+uint8_t* sdtp_buffer_get_write_span(sdtp_buffer_t* buffer, size_t* span_len) {
+	if (!buffer || !span_len) return NULL;
+	*span_len = 0;
+
+	const size_t free_space = sdtp_buffer_get_free_space(buffer);
+	if (free_space == 0) return NULL;
+
+	// Span ends either at the head or at the end of the memory
+	const size_t start = atomic_load_explicit(&buffer->tail, memory_order_relaxed) & buffer->mask;
+	const size_t to_end = buffer->size - start;
+
+	*span_len = free_space < to_end ? free_space : to_end;
+	return buffer->data + start;
+}
+
+size_t sdtp_buffer_commit(sdtp_buffer_t* buffer, size_t len) {
+	if (!buffer) return 0;
+
+	const size_t free_space = sdtp_buffer_get_free_space(buffer);
+	if (len > free_space) len = free_space;
+
+	sdtp_buffer_store_tail(buffer, atomic_load_explicit(&buffer->tail, memory_order_relaxed) + len);
+
+	sdtp_buffer_check_level(buffer);
+
+	return len;
 }
 
 sdtp_buffer_t* sdtp_buffer_get_by_type(sdtp_instance_t* instance, const sdtp_buffer_type_t buffer_type) {
@@ -2,47 +2,545 @@
 
 #include <api/libsdtp.h>
 
-#include <stdlib.h>
+#include <string.h>
+
+// Starts flush deadline when the frame is the oldest pending output
+static void sdtp_mark_pending(sdtp_instance_t* instance, const size_t frame_size) {
+	if (!instance->coalesce.enabled) return;
+
+	const size_t pending = sdtp_output_pending(instance);
+	if (pending == frame_size) instance->pending_since = sdtp_instance_now(instance);
+}
+
+// Buffer the frame waits in: queue of its class or the output buffer
+static sdtp_buffer_t* sdtp_output_target(sdtp_instance_t* instance, const sdtp_priority_t priority) {
+	if (instance->scheduler.enabled && (uint32_t)priority < SDTP_PRIORITY_CLASSES) {
+		return &instance->scheduler.queues[priority];
+	}
+
+	return sdtp_buffer_get_by_type(instance, SDTP_OUTPUT_BUFFER);
+}
+
+// Largest frame the target buffer takes
+static size_t sdtp_output_limit(const sdtp_instance_t* instance, const sdtp_buffer_t* buffer) {
+	return buffer->size < instance->config.buffer_size ? buffer->size : instance->config.buffer_size;
+}
+
+// Header format of output frames (NULL - full header)
+static const sdtp_header_format_t* sdtp_output_format(const sdtp_instance_t* instance) {
+	if (!instance->compact_header || !(sdtp_link_get_features(instance) & SDTP_FEATURE_COMPACT_HEADER)) return NULL;
+
+	return &instance->header_format;
+}
+
+// Serializes a frame, flushes pending output first if there's no room
+static size_t sdtp_output_frame(sdtp_instance_t* instance, sdtp_buffer_t* buffer, const sdtp_iovec_t* iov,
+                                const size_t iov_count, const sdtp_packet_type_t packet_type, const uint32_t packet_id) {
+	const sdtp_header_format_t* format = sdtp_output_format(instance);
+
+	size_t written = sdtp_serialize_iov_format_into(iov, iov_count, packet_type, packet_id, format, buffer);
+	if (written == 0 && sdtp_buffer_get_used_space(buffer) > 0) {
+		// Busy channel may still have freed enough room
+		sdtp_flush(instance);
+		written = sdtp_serialize_iov_format_into(iov, iov_count, packet_type, packet_id, format, buffer);
+	}
+	if (written == 0) return 0;
+
+	sdtp_mark_pending(instance, written);
+
+	return written;
+}
+
+// Position in payload fragments
+typedef struct {
+	size_t index;
+	size_t index_offset;
+} sdtp_iov_cursor_t;
+
+// Collects payload pieces of the next fragment after the prefix segment. Returns payload length.
+static size_t sdtp_fragment_next(const sdtp_iovec_t* iov, const size_t iov_count, const size_t chunk,
+                                 sdtp_iov_cursor_t* cursor, sdtp_iovec_t* segments, size_t* count) {
+	size_t len = 0;
+	while (len < chunk && cursor->index < iov_count && *count < SDTP_IOV_MAX) {
+		size_t take = iov[cursor->index].len - cursor->index_offset;
+		if (take > chunk - len) take = chunk - len;
+
+		if (take > 0) segments[(*count)++] = (sdtp_iovec_t){ iov[cursor->index].base + cursor->index_offset, take };
+		len += take;
+		cursor->index_offset += take;
+
+		if (cursor->index_offset == iov[cursor->index].len) {
+			cursor->index++;
+			cursor->index_offset = 0;
+		}
+	}
+
+	return len;
+}
+
+// Largest output of fragments from the cursor on (every fragment with the full header)
+static size_t sdtp_fragments_size(const sdtp_iovec_t* iov, const size_t iov_count, const size_t chunk,
+                                  sdtp_iov_cursor_t cursor) {
+	size_t total = 0;
+	for (;;) {
+		sdtp_iovec_t segments[SDTP_IOV_MAX];
+		size_t count = 1;
+		const size_t len = sdtp_fragment_next(iov, iov_count, chunk, &cursor, segments, &count);
+		if (len == 0) return total;
+
+		total += SDTP_FRAME_SIZE(SDTP_FRAGMENT_PREFIX_SIZE + len);
+	}
+}
+
+// Splits payload into fragments which fit the target buffer
+static size_t sdtp_output_fragments(sdtp_instance_t* instance, sdtp_buffer_t* buffer, const sdtp_iovec_t* iov,
+                                    const size_t iov_count, const size_t data_size,
+                                    const sdtp_packet_type_t packet_type, const uint32_t packet_id) {
+	const size_t limit = sdtp_output_limit(instance, buffer);
+	if (limit <= SDTP_FRAME_SIZE(SDTP_FRAGMENT_PREFIX_SIZE)) return 0;
+	const size_t chunk = limit - SDTP_FRAME_SIZE(SDTP_FRAGMENT_PREFIX_SIZE);
+
+	const sdtp_packet_type_t fragment_type = (sdtp_packet_type_t)((uint32_t)packet_type | SDTP_TYPE_FRAGMENT);
+
+	// Same payload written again after a busy channel continues where it stopped
+	sdtp_fragment_progress_t* progress = &instance->fragment_progress;
+	const bool resumed = progress->active && progress->id == packet_id && progress->type == (uint32_t)packet_type &&
+	                     progress->data_size == data_size;
+	size_t offset = resumed ? progress->offset : 0;
+	progress->active = false;
+
+	sdtp_iov_cursor_t cursor = { 0, 0 };
+	for (size_t skip = offset; skip > 0 && cursor.index < iov_count;) {
+		const size_t take = iov[cursor.index].len < skip ? iov[cursor.index].len : skip;
+		cursor.index_offset = take;
+		skip -= take;
+
+		if (cursor.index_offset == iov[cursor.index].len) {
+			cursor.index++;
+			cursor.index_offset = 0;
+		}
+	}
+
+	// Fragments which fit the buffer together go all or none, the peer never sees a part of them
+	const size_t required = sdtp_fragments_size(iov, iov_count, chunk, cursor);
+	if (required <= buffer->size && required > sdtp_buffer_get_free_space(buffer)) {
+		sdtp_flush(instance);
+		if (required > sdtp_buffer_get_free_space(buffer)) return 0;
+	}
+
+	size_t total = 0;
+	while (offset < data_size) {
+		const uint32_t prefix[2] = { (uint32_t)data_size, (uint32_t)offset };
+
+		// Prefix, then payload pieces up to the chunk size
+		sdtp_iovec_t segments[SDTP_IOV_MAX];
+		size_t count = 0;
+		segments[count++] = (sdtp_iovec_t){ (const uint8_t*)prefix, SDTP_FRAGMENT_PREFIX_SIZE };
+
+		const size_t len = sdtp_fragment_next(iov, iov_count, chunk, &cursor, segments, &count);
+
+		// Larger payload streams through the buffer, a busy channel stops it until the next write
+		const size_t written = sdtp_output_frame(instance, buffer, segments, count, fragment_type, packet_id);
+		if (written == 0) {
+			if (offset > 0) {
+				*progress = (sdtp_fragment_progress_t){ true, packet_id, (uint32_t)packet_type, data_size, offset };
+			}
+			return 0;
+		}
+
+		offset += len;
+		total += written;
+	}
+
+	return total;
+}
+
+// Points the payload at its compressed form if the peer takes it and it shrinks
+static void sdtp_output_compress(sdtp_instance_t* instance, const sdtp_iovec_t** iov, size_t* iov_count,
+                                 size_t* data_size, sdtp_packet_type_t* packet_type, sdtp_iovec_t* compressed) {
+	sdtp_compression_t* compression = &instance->compression;
+	if (!compression->enabled || !(sdtp_link_get_features(instance) & SDTP_FEATURE_COMPRESSION)) return;
+
+	// Parts of a payload are never compressed on their own, larger payloads don't fit the scratch
+	if (((uint32_t)*packet_type & (SDTP_TYPE_COMPRESSED | SDTP_TYPE_FRAGMENT)) != 0) return;
+	if (*data_size < SDTP_COMPRESS_MIN_SIZE || *data_size > instance->config.buffer_size) return;
+
+	uint32_t* table = (uint32_t*)(void*)compression->storage;
+	uint8_t* gather = compression->storage + SDTP_COMPRESS_TABLE_SIZE * sizeof(uint32_t);
+	uint8_t* out = gather + instance->config.buffer_size;
+
+	// Match finder needs the payload in one piece
+	const uint8_t* source = *iov_count == 1 ? (*iov)[0].base : gather;
+	if (*iov_count > 1) {
+		size_t done = 0;
+		for (size_t i = 0; i < *iov_count; ++i) {
+			if ((*iov)[i].len > 0) memcpy(gather + done, (*iov)[i].base, (*iov)[i].len);
+			done += (*iov)[i].len;
+		}
+	}
+
+	// Stream must beat the payload including its size prefix
+	const size_t capacity = *data_size - SDTP_COMPRESS_PREFIX_SIZE - 1;
+	const size_t stream_len = sdtp_compress(source, *data_size, out + SDTP_COMPRESS_PREFIX_SIZE, capacity, table);
+	if (stream_len == 0) {
+		compression->skipped++;
+		return;
+	}
+
+	const uint32_t size = (uint32_t)*data_size;
+	memcpy(out, &size, SDTP_COMPRESS_PREFIX_SIZE);
+
+	*compressed = (sdtp_iovec_t){ out, SDTP_COMPRESS_PREFIX_SIZE + stream_len };
+	*iov = compressed;
+	*iov_count = 1;
+	*data_size = compressed->len;
+	*packet_type = (sdtp_packet_type_t)((uint32_t)*packet_type | SDTP_TYPE_COMPRESSED);
+	compression->compressed++;
+}
+
+// Serializes packet into the buffer of its class
+static size_t sdtp_output_iov(sdtp_instance_t* instance, const sdtp_iovec_t* iov, size_t iov_count,
+                              size_t data_size, sdtp_packet_type_t packet_type,
+                              const uint32_t packet_id, const sdtp_priority_t priority) {
+	sdtp_buffer_t* buffer = sdtp_output_target(instance, priority);
+	if (!buffer) return 0;
+
+	sdtp_iovec_t compressed;
+	sdtp_output_compress(instance, &iov, &iov_count, &data_size, &packet_type, &compressed);
+
+	// Packets which don't fit are sent in parts
+	if (SDTP_FRAME_SIZE(data_size) > sdtp_output_limit(instance, buffer)) {
+		return sdtp_output_fragments(instance, buffer, iov, iov_count, data_size, packet_type, packet_id);
+	}
+
+	return sdtp_output_frame(instance, buffer, iov, iov_count, packet_type, packet_id);
+}
+
+// Serializes packet into the buffer of its class
+static size_t sdtp_output_packet(sdtp_instance_t* instance, const sdtp_packet_t* packet, const sdtp_priority_t priority) {
+	const sdtp_iovec_t body = { packet->body, packet->header.data_size };
+
+	return sdtp_output_iov(instance, &body, body.len > 0 ? 1 : 0, body.len,
+	                       (sdtp_packet_type_t)packet->header.type, packet->header.id, priority);
+}
+
+size_t sdtp_output_packet_iov(sdtp_instance_t* instance, const sdtp_iovec_t* iov, const size_t iov_count,
+                              const sdtp_packet_type_t packet_type, const uint32_t packet_id,
+                              const sdtp_priority_t priority) {
+	if (!instance) return 0;
+
+	const size_t data_size = sdtp_iov_length(iov, iov_count);
+	if (data_size == SIZE_MAX) return 0;
+
+	return sdtp_output_iov(instance, iov, iov_count, data_size, packet_type, packet_id, priority);
+}
+
+bool sdtp_output_is_plain(const sdtp_instance_t* instance) {
+	if (!instance) return false;
+
+	const bool compressing = instance->compression.enabled &&
+	                         (sdtp_link_get_features(instance) & SDTP_FEATURE_COMPRESSION);
+
+	return !instance->scheduler.enabled && !compressing && !sdtp_output_format(instance);
+}
 
 bool sdtp_write_packet(sdtp_instance_t* instance, const sdtp_packet_t* packet) {
 	if (!instance || !packet) return false;
 
-	// Get buffer
-	sdtp_buffer_t* buffer = sdtp_buffer_get_by_type(instance, SDTP_OUTPUT_BUFFER);
-	if (!buffer) {
-		return false;
+	return sdtp_write_packet_priority(instance, packet, sdtp_get_type_priority(instance, packet->header.type));
+}
+
+bool sdtp_write_packet_priority(sdtp_instance_t* instance, const sdtp_packet_t* packet, const sdtp_priority_t priority) {
+	if (!instance || !packet) return false;
+
+	if (sdtp_output_packet(instance, packet, priority) == 0) return false;
+
+	// Trigger a write call (only when due if coalescing)
+	const bool status = sdtp_flush_due(instance);
+
+	return status;
+}
+
+size_t sdtp_write_packets(sdtp_instance_t* instance, const sdtp_packet_t* const* packets, const size_t count) {
+	if (!instance || !packets) return 0;
+
+	// Serialize packets in place, flush the batch early only if there's no room
+	size_t written = 0;
+	size_t sent = 0;
+	while (written < count) {
+		const sdtp_packet_t* packet = packets[written];
+		if (!packet) break;
+
+		const size_t pending = sdtp_output_pending(instance);
+
+		const sdtp_priority_t priority = sdtp_get_type_priority(instance, packet->header.type);
+		const size_t frame_size = sdtp_output_packet(instance, packet, priority);
+		if (frame_size == 0) break;
+
+		// Early flush went through, so everything before this packet is out
+		const size_t pending_now = sdtp_output_pending(instance);
+		if (pending_now < pending + frame_size) sent = written;
+
+		written++;
 	}
 
-	// Serialize packet into a temporary buffer
-	size_t serialized_size = 0;
-	uint8_t* serialized = sdtp_serialize_packet(packet, &serialized_size);
-	if (!serialized) return false;
+	// Trigger a single write call for the whole batch (only when due if coalescing)
+	if (!sdtp_flush_due(instance)) return sent;
 
-	// Ensure serialized packet fits into buffer
-	if (serialized_size > instance->config.buffer_size) {
-		free(serialized);
-		return false;
+	return written;
+}
+
+// Sends fragments to writev as they are, bypassing the output buffer
+static bool sdtp_writev_packet(sdtp_instance_t* instance, const sdtp_iovec_t* iov, const size_t iov_count,
+                               const size_t data_size, const sdtp_packet_type_t packet_type, const uint32_t packet_id) {
+	const sdtp_function_hooks_v2* hooks = instance->hooks_v2;
+
+	// Checksum is needed before the header goes out
+	uint8_t head[SDTP_HEAD_MAX_SIZE];
+	sdtp_fletcher32_state_t state;
+	const size_t head_size = sdtp_header_begin(head, sdtp_output_format(instance), (uint32_t)packet_type, packet_id,
+	                                           data_size, &state);
+	for (size_t i = 0; i < iov_count; ++i) {
+		sdtp_fletcher32_update(&state, iov[i].base, iov[i].len);
+	}
+	sdtp_header_finish(head, head_size, &state);
+
+	const uint8_t terminator = SDTP_TERMINATOR;
+
+	// Header, non-empty fragments, terminator
+	sdtp_iovec_t segments[SDTP_IOV_MAX];
+	size_t count = 0;
+	segments[count++] = (sdtp_iovec_t){ head, head_size };
+	for (size_t i = 0; i < iov_count; ++i) {
+		if (iov[i].len > 0) segments[count++] = iov[i];
 	}
+	segments[count++] = (sdtp_iovec_t){ &terminator, 1 };
 
-	// Attempt to write serialized packet into output buffer
-	const size_t written = sdtp_buffer_write(buffer, serialized, serialized_size);
-	free(serialized);
+	const size_t frame_size = head_size + data_size + 1;
+	size_t written = hooks->writev(hooks->ctx, segments, count);
+	if (written >= frame_size) return true;
 
-	// If not all bytes were written
-	if (written != serialized_size) return false;
+	// Unsent tail waits in the output buffer, it's empty and has room for a whole frame
+	sdtp_buffer_t* buffer = instance->output_buffer;
+	size_t staged = 0;
+	for (size_t i = 0; i < count; ++i) {
+		if (written >= segments[i].len) {
+			written -= segments[i].len;
+			continue;
+		}
 
-	// Trigger a write call
-	const bool status = sdtp_io_write(instance);
+		const size_t len = segments[i].len - written;
+		sdtp_buffer_stage(buffer, staged, segments[i].base + written, len);
+		staged += len;
+		written = 0;
+	}
+	sdtp_buffer_commit(buffer, staged);
 
-	return status;
+	return true;
 }
 
-sdtp_packet_t* sdtp_read_packet(sdtp_instance_t* instance, sdtp_read_mode_t mode) {
+bool sdtp_write_packet_iov(sdtp_instance_t* instance, const sdtp_iovec_t* iov, size_t iov_count,
+                           sdtp_packet_type_t packet_type, const uint32_t packet_id) {
+	if (!instance) return false;
+
+	size_t data_size = sdtp_iov_length(iov, iov_count);
+	if (data_size == SIZE_MAX) return false;
+
+	// Compressed once here, so both paths below send the same frame
+	sdtp_iovec_t compressed;
+	sdtp_output_compress(instance, &iov, &iov_count, &data_size, &packet_type, &compressed);
+
+	// Nothing to order against: hand the fragments to the hook directly
+	if (instance->hooks_v2 && instance->hooks_v2->writev && !instance->coalesce.enabled &&
+	    iov_count <= SDTP_IOV_MAX - 2 && SDTP_FRAME_SIZE(data_size) <= instance->config.buffer_size &&
+	    sdtp_buffer_get_used_space(instance->output_buffer) == 0 && sdtp_priority_pending(instance) == 0) {
+		return sdtp_writev_packet(instance, iov, iov_count, data_size, packet_type, packet_id);
+	}
+
+	// Serialize in place, flush pending data first if there's no room
+	const sdtp_priority_t priority = sdtp_get_type_priority(instance, packet_type);
+	if (sdtp_output_iov(instance, iov, iov_count, data_size, packet_type, packet_id, priority) == 0) return false;
+
+	// Trigger a write call (only when due if coalescing)
+	return sdtp_flush_due(instance);
+}
+
+// Copies the frame at the parser position into a new packet
+static sdtp_packet_t* sdtp_copy_packet(sdtp_instance_t* instance, sdtp_buffer_t* buffer,
+                                       const sdtp_packet_header_t* header, const sdtp_read_mode_t mode) {
+	// Allocate packet with the body in the same block
+	sdtp_packet_t* packet = sdtp_packet_alloc(instance->config.allocator, header->data_size);
+	if (!packet) return NULL;
+
+	packet->header = *header;
+
+	// Copy body
+	if (header->data_size > 0) {
+		sdtp_buffer_peek(buffer, instance->parser.offset + instance->parser.head_size, packet->body, header->data_size);
+	}
+
+	// Handle different read modes
+	switch (mode) {
+		case SDTP_READ_FULL:
+			sdtp_parser_release(&instance->parser, buffer);
+			sdtp_parser_skip(&instance->parser, buffer, sdtp_buffer_get_used_space(buffer) - instance->parser.offset);
+			break;
+
+		case SDTP_READ_PARTIAL:
+			sdtp_parser_release(&instance->parser, buffer);
+			break;
+
+		default:
+			break;
+	}
+
+	return packet;
+}
+
+// Advances the parser, compact headers are taken only once both ends agreed to them
+static bool sdtp_parse_next(sdtp_instance_t* instance, sdtp_buffer_t* buffer, sdtp_packet_header_t* header) {
+	instance->parser.compact = (sdtp_link_get_features(instance) & SDTP_FEATURE_COMPACT_HEADER) != 0;
+
+	return sdtp_parser_next(&instance->parser, buffer, header);
+}
+
+// Borrows the next verified frame
+static bool sdtp_take_packet_view(sdtp_instance_t* instance, sdtp_buffer_t* buffer, sdtp_packet_view_t* view) {
+	// Parser returns only frames with a verified checksum
+	sdtp_packet_header_t header;
+	if (!sdtp_parse_next(instance, buffer, &header)) return false;
+
+	const uint8_t* body = NULL;
+	if (header.data_size > 0) {
+		const size_t body_offset = instance->parser.offset + instance->parser.head_size;
+
+		size_t span_len = 0;
+		body = sdtp_buffer_get_read_span(buffer, body_offset, &span_len);
+
+		// Body wrapped around the buffer end. Only one frame can wrap at a time,
+		// so a single linear copy is enough.
+		if (span_len < header.data_size) {
+			// Buffer may have grown since the scratch was allocated, no view uses it now
+			if (!instance->view_scratch || instance->view_scratch_size < header.data_size) {
+				if (instance->view_scratch) {
+					sdtp_allocator_free(instance->config.allocator, instance->view_scratch, instance->view_scratch_size);
+				}
+
+				instance->view_scratch = (uint8_t*)sdtp_allocator_alloc(instance->config.allocator, buffer->size);
+				instance->view_scratch_size = instance->view_scratch ? buffer->size : 0;
+				if (!instance->view_scratch) return false;
+			}
+
+			sdtp_buffer_peek(buffer, body_offset, instance->view_scratch, header.data_size);
+			body = instance->view_scratch;
+		}
+	}
+
+	view->header = header;
+	view->body = body;
+	view->span = sdtp_parser_hold(&instance->parser);
+
+	// Overflow handling must not move held bytes
+	buffer->pinned = instance->parser.offset;
+
+	return true;
+}
+
+// Whether the frame has layers to strip before delivery, fragments are reassembled first
+static bool sdtp_wrapped(const sdtp_instance_t* instance, const uint32_t type) {
+	if (type & SDTP_TYPE_FRAGMENT) return false;
+	if (type & SDTP_TYPE_COMPRESSED) return true;
+
+	return instance->reliable.enabled && ((type & SDTP_TYPE_RELIABLE) || SDTP_TYPE_BASE(type) == SDTP_ACK);
+}
+
+// Copies frame to deliver without its layers (NULL - ack, duplicate, held, corrupt or no memory)
+static sdtp_packet_t* sdtp_unwrap_packet(sdtp_instance_t* instance, const sdtp_packet_view_t* view) {
+	// Decompressed payload may be a reliable frame itself
+	if (view->header.type & SDTP_TYPE_COMPRESSED) {
+		// Only peers that negotiated compression may send it, payloads are never larger than a buffer
+		if (!(sdtp_link_get_features(instance) & SDTP_FEATURE_COMPRESSION)) return NULL;
+
+		sdtp_packet_t* packet = sdtp_decompress_packet(instance->config.allocator, view, instance->config.buffer_size);
+		if (!packet || !sdtp_wrapped(instance, packet->header.type)) return packet;
+
+		const sdtp_packet_view_t whole = { packet->header, packet->body, 0 };
+		sdtp_packet_t* inner = sdtp_unwrap_packet(instance, &whole);
+		sdtp_packet_free(packet);
+
+		return inner;
+	}
+
+	if (SDTP_TYPE_BASE(view->header.type) == SDTP_ACK) {
+		sdtp_packet_view_t inner;
+		sdtp_reliable_receive(instance, view, &inner);
+		return NULL;
+	}
+
+	// Allocate first, an acknowledged frame is never sent again. Body loses its sequence,
+	// so the packet is freed with the size it was allocated with.
+	const size_t prefix = view->header.data_size >= SDTP_RELIABLE_PREFIX_SIZE ? SDTP_RELIABLE_PREFIX_SIZE : 0;
+	sdtp_packet_t* packet = sdtp_packet_alloc(instance->config.allocator, view->header.data_size - prefix);
+	if (!packet) return NULL;
+
+	sdtp_packet_view_t inner;
+	if (!sdtp_reliable_receive(instance, view, &inner)) {
+		sdtp_packet_free(packet);
+		return NULL;
+	}
+
+	packet->header = inner.header;
+	if (inner.header.data_size > 0) memcpy(packet->body, inner.body, inner.header.data_size);
+
+	return packet;
+}
+
+// Copies the next verified frame into a new packet, reassembling fragments and stripping layers
+static sdtp_packet_t* sdtp_take_packet(sdtp_instance_t* instance, sdtp_buffer_t* buffer, const sdtp_read_mode_t mode) {
+	// Frames which arrived early follow the one they waited for
+	if (mode != SDTP_READ_PEEK) {
+		sdtp_packet_t* held = sdtp_reliable_take_held(instance);
+		if (held) return held;
+	}
+
+	// Parser returns only frames with a verified checksum
+	sdtp_packet_header_t header;
+	while (sdtp_parse_next(instance, buffer, &header)) {
+		const bool fragment = instance->reassembly.enabled && (header.type & SDTP_TYPE_FRAGMENT);
+		if (mode == SDTP_READ_PEEK || (!fragment && !sdtp_wrapped(instance, header.type))) {
+			return sdtp_copy_packet(instance, buffer, &header, mode);
+		}
+
+		// Fragments are consumed until their payload completes
+		sdtp_packet_view_t view;
+		if (!sdtp_take_packet_view(instance, buffer, &view)) return NULL;
+		sdtp_packet_t* packet = fragment ? sdtp_reassembly_insert(instance, &view) : sdtp_unwrap_packet(instance, &view);
+		sdtp_packet_view_release(instance, &view);
+		if (!packet) continue;
+
+		// Reassembled payload may be wrapped itself
+		if (fragment && sdtp_wrapped(instance, packet->header.type)) {
+			const sdtp_packet_view_t whole = { packet->header, packet->body, 0 };
+			sdtp_packet_t* inner = sdtp_unwrap_packet(instance, &whole);
+			sdtp_packet_free(packet);
+			if (!inner) continue;
+			packet = inner;
+		}
+
+		if (mode == SDTP_READ_FULL) {
+			sdtp_parser_skip(&instance->parser, buffer, sdtp_buffer_get_used_space(buffer) - instance->parser.offset);
+		}
+		return packet;
+	}
+
+	return NULL;
+}
+
+sdtp_packet_t* sdtp_read_packet(sdtp_instance_t* instance, const sdtp_read_mode_t mode) {
 	if (!instance) return NULL;
 
-	// Trigger a read call
-	const bool status = sdtp_io_read(instance);
-	if (!status) return NULL;
+	// Trigger a read call (frames may already be buffered, so no data is fine)
+	sdtp_io_read(instance);
 
 	// Get buffer
 	sdtp_buffer_t* buffer = sdtp_buffer_get_by_type(instance, SDTP_INPUT_BUFFER);
@@ -50,18 +548,87 @@ sdtp_packet_t* sdtp_read_packet(sdtp_instance_t* instance, sdtp_read_mode_t mode
 		return NULL;
 	}
 
-	// TODO: Get only last packet
-	const size_t read_len = sdtp_buffer_get_used_space(instance->input_buffer);
+	sdtp_packet_t* packet = sdtp_take_packet(instance, buffer, mode);
+
+	// Acknowledge what was read, repair what the peer missed
+	sdtp_reliable_poll(instance);
 
-	// Allocate serialized buffer and copy packet bytes
-	uint8_t* serialized = (uint8_t*)malloc(read_len);
-	if (!serialized) return NULL;
+	return packet;
+}
 
-	const size_t serialized_len = sdtp_buffer_read(buffer, serialized, read_len, mode);
+size_t sdtp_read_packets(sdtp_instance_t* instance, sdtp_packet_t** out, const size_t max) {
+	if (!instance || !out || max == 0) return 0;
 
-	// Deserialize
-	sdtp_packet_t* packet = sdtp_deserialize_packet(serialized, serialized_len);
-	free(serialized);
+	// Trigger a single read call for the whole batch
+	sdtp_io_read(instance);
 
-	return packet;
+	// Get buffer
+	sdtp_buffer_t* buffer = sdtp_buffer_get_by_type(instance, SDTP_INPUT_BUFFER);
+	if (!buffer) {
+		return 0;
+	}
+
+	// Drain every complete frame
+	size_t count = 0;
+	while (count < max) {
+		sdtp_packet_t* packet = sdtp_take_packet(instance, buffer, SDTP_READ_PARTIAL);
+		if (!packet) break;
+
+		out[count++] = packet;
+	}
+
+	// Acknowledge what was read, repair what the peer missed
+	sdtp_reliable_poll(instance);
+
+	return count;
+}
+
+bool sdtp_read_packet_view(sdtp_instance_t* instance, sdtp_packet_view_t* view) {
+	if (!instance || !view) return false;
+
+	// Trigger a read call (frames may already be buffered, so no data is fine)
+	sdtp_io_read(instance);
+
+	// Get buffer
+	sdtp_buffer_t* buffer = sdtp_buffer_get_by_type(instance, SDTP_INPUT_BUFFER);
+	if (!buffer) {
+		return false;
+	}
+
+	return sdtp_take_packet_view(instance, buffer, view);
+}
+
+size_t sdtp_read_packet_views(sdtp_instance_t* instance, sdtp_packet_view_t* views, const size_t max) {
+	if (!instance || !views || max == 0) return 0;
+
+	// Trigger a single read call for the whole batch
+	sdtp_io_read(instance);
+
+	// Get buffer
+	sdtp_buffer_t* buffer = sdtp_buffer_get_by_type(instance, SDTP_INPUT_BUFFER);
+	if (!buffer) {
+		return 0;
+	}
+
+	// Borrow every complete frame
+	size_t count = 0;
+	while (count < max && sdtp_take_packet_view(instance, buffer, &views[count])) {
+		count++;
+	}
+
+	return count;
+}
+
+void sdtp_packet_view_release(sdtp_instance_t* instance, sdtp_packet_view_t* view) {
+	if (!instance || !view || view->span == 0) return;
+
+	sdtp_buffer_t* buffer = sdtp_buffer_get_by_type(instance, SDTP_INPUT_BUFFER);
+	if (!buffer) return;
+
+	sdtp_parser_unhold(&instance->parser, buffer, view->span);
+	buffer->pinned = instance->parser.views > 0 ? instance->parser.offset : 0;
+
+	// Prevent double release
+	view->body = NULL;
+	view->span = 0;
 }
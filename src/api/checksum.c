@@ -0,0 +1,358 @@
+// Copyright (c) 2026 bazelik
+
+#include <api/libsdtp.h>
+
+#include <stdatomic.h>
+#include <string.h>
+
+#if !defined(SDTP_DISABLE_SIMD) && defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SDTP_FLETCHER32_X86
+#include <immintrin.h>
+#elif !defined(SDTP_DISABLE_SIMD) && defined(__ARM_NEON) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define SDTP_FLETCHER32_NEON
+#include <arm_neon.h>
+#endif
+
+/**
+ * Fletcher-32 block kernel.
+ * Adds word_len 16-bit words (host byte order) to the sums.
+ * Sums must be reduced modulo 65535 on input and are reduced on output.
+ **/
+typedef void (*sdtp_fletcher32_kernel_t)(uint32_t* c0, uint32_t* c1, const uint8_t* data, size_t word_len);
+
+// Adapted from Wikipedia's Fletcher checksum article
+// https://en.wikipedia.org/wiki/Fletcher%27s_checksum
+// Original content licensed under CC BY-SA
+static void sdtp_fletcher32_scalar(uint32_t* sum0, uint32_t* sum1, const uint8_t* data, size_t word_len)
+{
+	uint32_t c0 = *sum0, c1 = *sum1;
+	size_t i;
+
+	for (; word_len >= 360; word_len -= 360) {
+		for (i = 0; i < 360; ++i) {
+			uint16_t word;
+			memcpy(&word, data, sizeof(word));
+			data += 2;
+			c0 = c0 + word;
+			c1 = c1 + c0;
+		}
+		c0 = c0 % 65535;
+		c1 = c1 % 65535;
+	}
+
+	for (i = 0; i < word_len; ++i) {
+		uint16_t word;
+		memcpy(&word, data, sizeof(word));
+		data += 2;
+		c0 = c0 + word;
+		c1 = c1 + c0;
+	}
+
+	*sum0 = c0 % 65535;
+	*sum1 = c1 % 65535;
+}
+
+#if defined(SDTP_FLETCHER32_X86) || defined(SDTP_FLETCHER32_NEON)
+
+/*******************************************************
+ * Vector kernels use the block-weighted-sum form.
+ * For a block of N words w[0..N-1]:
+ *   c0' = c0 + sum(w[j])
+ *   c1' = c1 + N * c0 + sum((N - j) * w[j])
+ * Each lane keeps a plain sum of its words (a) and a sum of
+ * a taken before every chunk (p), so for chunks of W words:
+ *   sum((N - j) * w[j]) = W * sum(p) + sum((W - lane) * a[lane])
+ * 32-bit lanes can't overflow while chunks per block <= 362.
+ ******************************************************/
+
+#define SDTP_FLETCHER32_BLOCK_CHUNKS 256
+
+// Folds lane sums of one block into the scalar sums
+static void sdtp_fletcher32_fold(uint32_t* c0, uint32_t* c1, const size_t block_words,
+                                 const uint64_t a_sum, const uint64_t p_sum, const uint64_t weighted_sum, const uint32_t chunk_words) {
+	const uint64_t sum1 = (uint64_t)*c1 + (uint64_t)block_words * *c0 + (uint64_t)chunk_words * p_sum + weighted_sum;
+	const uint64_t sum0 = (uint64_t)*c0 + a_sum;
+
+	*c0 = (uint32_t)(sum0 % 65535);
+	*c1 = (uint32_t)(sum1 % 65535);
+}
+
+#endif
+
+#ifdef SDTP_FLETCHER32_X86
+
+static void sdtp_fletcher32_sse2(uint32_t* c0, uint32_t* c1, const uint8_t* data, size_t word_len)
+{
+	const __m128i zero = _mm_setzero_si128();
+
+	while (word_len >= 8) {
+		size_t chunks = word_len / 8;
+		if (chunks > SDTP_FLETCHER32_BLOCK_CHUNKS) chunks = SDTP_FLETCHER32_BLOCK_CHUNKS;
+
+		__m128i a_lo = zero, a_hi = zero, p_lo = zero, p_hi = zero;
+
+		for (size_t k = 0; k < chunks; ++k) {
+			const __m128i words = _mm_loadu_si128((const __m128i*)(const void*)data);
+			data += 16;
+
+			p_lo = _mm_add_epi32(p_lo, a_lo);
+			p_hi = _mm_add_epi32(p_hi, a_hi);
+			a_lo = _mm_add_epi32(a_lo, _mm_unpacklo_epi16(words, zero));
+			a_hi = _mm_add_epi32(a_hi, _mm_unpackhi_epi16(words, zero));
+		}
+
+		uint32_t a[8], p[8];
+		_mm_storeu_si128((__m128i*)(void*)a, a_lo);
+		_mm_storeu_si128((__m128i*)(void*)(a + 4), a_hi);
+		_mm_storeu_si128((__m128i*)(void*)p, p_lo);
+		_mm_storeu_si128((__m128i*)(void*)(p + 4), p_hi);
+
+		uint64_t a_sum = 0, p_sum = 0, weighted_sum = 0;
+		for (uint32_t lane = 0; lane < 8; ++lane) {
+			a_sum += a[lane];
+			p_sum += p[lane];
+			weighted_sum += (uint64_t)(8 - lane) * a[lane];
+		}
+
+		sdtp_fletcher32_fold(c0, c1, chunks * 8, a_sum, p_sum, weighted_sum, 8);
+		word_len -= chunks * 8;
+	}
+
+	sdtp_fletcher32_scalar(c0, c1, data, word_len);
+}
+
+__attribute__((target("avx2")))
+static void sdtp_fletcher32_avx2(uint32_t* c0, uint32_t* c1, const uint8_t* data, size_t word_len)
+{
+	while (word_len >= 16) {
+		size_t chunks = word_len / 16;
+		if (chunks > SDTP_FLETCHER32_BLOCK_CHUNKS) chunks = SDTP_FLETCHER32_BLOCK_CHUNKS;
+
+		__m256i a_lo = _mm256_setzero_si256(), a_hi = _mm256_setzero_si256();
+		__m256i p_lo = _mm256_setzero_si256(), p_hi = _mm256_setzero_si256();
+
+		for (size_t k = 0; k < chunks; ++k) {
+			const __m128i words_lo = _mm_loadu_si128((const __m128i*)(const void*)data);
+			const __m128i words_hi = _mm_loadu_si128((const __m128i*)(const void*)(data + 16));
+			data += 32;
+
+			p_lo = _mm256_add_epi32(p_lo, a_lo);
+			p_hi = _mm256_add_epi32(p_hi, a_hi);
+			a_lo = _mm256_add_epi32(a_lo, _mm256_cvtepu16_epi32(words_lo));
+			a_hi = _mm256_add_epi32(a_hi, _mm256_cvtepu16_epi32(words_hi));
+		}
+
+		uint32_t a[16], p[16];
+		_mm256_storeu_si256((__m256i*)(void*)a, a_lo);
+		_mm256_storeu_si256((__m256i*)(void*)(a + 8), a_hi);
+		_mm256_storeu_si256((__m256i*)(void*)p, p_lo);
+		_mm256_storeu_si256((__m256i*)(void*)(p + 8), p_hi);
+
+		uint64_t a_sum = 0, p_sum = 0, weighted_sum = 0;
+		for (uint32_t lane = 0; lane < 16; ++lane) {
+			a_sum += a[lane];
+			p_sum += p[lane];
+			weighted_sum += (uint64_t)(16 - lane) * a[lane];
+		}
+
+		sdtp_fletcher32_fold(c0, c1, chunks * 16, a_sum, p_sum, weighted_sum, 16);
+		word_len -= chunks * 16;
+	}
+
+	sdtp_fletcher32_sse2(c0, c1, data, word_len);
+}
+
+#endif // SDTP_FLETCHER32_X86
+
+#ifdef SDTP_FLETCHER32_NEON
+
+static void sdtp_fletcher32_neon(uint32_t* c0, uint32_t* c1, const uint8_t* data, size_t word_len)
+{
+	while (word_len >= 8) {
+		size_t chunks = word_len / 8;
+		if (chunks > SDTP_FLETCHER32_BLOCK_CHUNKS) chunks = SDTP_FLETCHER32_BLOCK_CHUNKS;
+
+		uint32x4_t a_lo = vdupq_n_u32(0), a_hi = vdupq_n_u32(0);
+		uint32x4_t p_lo = vdupq_n_u32(0), p_hi = vdupq_n_u32(0);
+
+		for (size_t k = 0; k < chunks; ++k) {
+			const uint16x8_t words = vreinterpretq_u16_u8(vld1q_u8(data));
+			data += 16;
+
+			p_lo = vaddq_u32(p_lo, a_lo);
+			p_hi = vaddq_u32(p_hi, a_hi);
+			a_lo = vaddw_u16(a_lo, vget_low_u16(words));
+			a_hi = vaddw_u16(a_hi, vget_high_u16(words));
+		}
+
+		uint32_t a[8], p[8];
+		vst1q_u32(a, a_lo);
+		vst1q_u32(a + 4, a_hi);
+		vst1q_u32(p, p_lo);
+		vst1q_u32(p + 4, p_hi);
+
+		uint64_t a_sum = 0, p_sum = 0, weighted_sum = 0;
+		for (uint32_t lane = 0; lane < 8; ++lane) {
+			a_sum += a[lane];
+			p_sum += p[lane];
+			weighted_sum += (uint64_t)(8 - lane) * a[lane];
+		}
+
+		sdtp_fletcher32_fold(c0, c1, chunks * 8, a_sum, p_sum, weighted_sum, 8);
+		word_len -= chunks * 8;
+	}
+
+	sdtp_fletcher32_scalar(c0, c1, data, word_len);
+}
+
+#endif // SDTP_FLETCHER32_NEON
+
+static _Atomic(sdtp_fletcher32_kernel_t) sdtp_fletcher32_kernel = NULL;
+
+static sdtp_fletcher32_kernel_t sdtp_fletcher32_select(void) {
+#if defined(SDTP_FLETCHER32_X86)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) return sdtp_fletcher32_avx2;
+	return sdtp_fletcher32_sse2;
+#elif defined(SDTP_FLETCHER32_NEON)
+	return sdtp_fletcher32_neon;
+#else
+	return sdtp_fletcher32_scalar;
+#endif
+}
+
+static sdtp_fletcher32_kernel_t sdtp_fletcher32_get_kernel(void) {
+	sdtp_fletcher32_kernel_t kernel = atomic_load_explicit(&sdtp_fletcher32_kernel, memory_order_relaxed);
+	if (kernel) return kernel;
+
+	sdtp_checksum_init();
+	return atomic_load_explicit(&sdtp_fletcher32_kernel, memory_order_relaxed);
+}
+
+void sdtp_checksum_init(void) {
+	if (atomic_load_explicit(&sdtp_fletcher32_kernel, memory_order_relaxed)) return;
+
+	// Every thread selects the same kernel, so racing stores are harmless
+	atomic_store_explicit(&sdtp_fletcher32_kernel, sdtp_fletcher32_select(), memory_order_relaxed);
+}
+
+bool sdtp_checksum_set_kernel(const sdtp_checksum_kernel_t kernel) {
+	sdtp_fletcher32_kernel_t selected = NULL;
+
+	switch (kernel) {
+		case SDTP_CHECKSUM_AUTO:
+			selected = sdtp_fletcher32_select();
+			break;
+
+		case SDTP_CHECKSUM_SCALAR:
+			selected = sdtp_fletcher32_scalar;
+			break;
+
+#if defined(SDTP_FLETCHER32_X86)
+		case SDTP_CHECKSUM_SSE2:
+			selected = sdtp_fletcher32_sse2;
+			break;
+
+		case SDTP_CHECKSUM_AVX2:
+			__builtin_cpu_init();
+			if (__builtin_cpu_supports("avx2")) selected = sdtp_fletcher32_avx2;
+			break;
+#elif defined(SDTP_FLETCHER32_NEON)
+		case SDTP_CHECKSUM_NEON:
+			selected = sdtp_fletcher32_neon;
+			break;
+#endif
+
+		default:
+			break;
+	}
+	if (!selected) return false;
+
+	atomic_store_explicit(&sdtp_fletcher32_kernel, selected, memory_order_relaxed);
+	return true;
+}
+
+void sdtp_fletcher32_init(sdtp_fletcher32_state_t* state) {
+	if (!state) return;
+
+	state->c0 = 0;
+	state->c1 = 0;
+	state->carry = 0;
+	state->has_carry = false;
+}
+
+void sdtp_fletcher32_update(sdtp_fletcher32_state_t* state, const uint8_t* data, size_t len) {
+	if (!state || !data || len == 0) return;
+
+	// Pair odd byte from the previous update with the first byte
+	if (state->has_carry) {
+		const uint8_t pair[2] = { state->carry, data[0] };
+		uint16_t word;
+		memcpy(&word, pair, sizeof(word));
+
+		state->c0 = (state->c0 + word) % 65535;
+		state->c1 = (state->c1 + state->c0) % 65535;
+		state->has_carry = false;
+
+		data += 1;
+		len -= 1;
+	}
+
+	sdtp_fletcher32_get_kernel()(&state->c0, &state->c1, data, len / 2);
+
+	// Keep odd byte until the next update or final
+	if (len & 1) {
+		state->carry = data[len - 1];
+		state->has_carry = true;
+	}
+}
+
+uint32_t sdtp_fletcher32_final(const sdtp_fletcher32_state_t* state) {
+	if (!state) return 0;
+
+	uint32_t c0 = state->c0;
+	uint32_t c1 = state->c1;
+
+	if (state->has_carry) {
+		c0 = c0 + state->carry;
+		c1 = c1 + c0;
+	}
+
+	c0 = c0 % 65535;
+	c1 = c1 % 65535;
+
+	return (c1 << 16 | c0);
+}
+
+uint32_t sdtp_calculate_fletcher32(const uint8_t *data, const size_t len)
+{
+	sdtp_fletcher32_state_t state;
+
+	sdtp_fletcher32_init(&state);
+	sdtp_fletcher32_update(&state, data, len);
+
+	return sdtp_fletcher32_final(&state);
+}
+
+uint32_t sdtp_copy_fletcher32(uint8_t *destination, const uint8_t *source, const size_t len)
+{
+	sdtp_fletcher32_state_t state;
+	sdtp_fletcher32_init(&state);
+
+	// Chunk stays in L1 cache until the kernel reads it back
+	size_t done = 0;
+	while (done < len) {
+		size_t chunk = len - done;
+		if (chunk > SDTP_FLETCHER32_CHUNK) chunk = SDTP_FLETCHER32_CHUNK;
+
+		memcpy(destination + done, source + done, chunk);
+		sdtp_fletcher32_update(&state, destination + done, chunk);
+		done += chunk;
+	}
+
+	return sdtp_fletcher32_final(&state);
+}
+
+bool sdtp_verify_fletcher32(const uint8_t *data, const size_t length, const uint32_t checksum) {
+	return sdtp_calculate_fletcher32(data, length) == checksum;
+}
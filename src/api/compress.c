@@ -0,0 +1,308 @@
+// Copyright (c) 2026 bazelik
+
+#include <api/libsdtp.h>
+
+#include <string.h>
+
+// Decoder positions in a sequence
+enum {
+	SDTP_DECOMPRESS_TOKEN,
+	SDTP_DECOMPRESS_LITERAL_LEN,
+	SDTP_DECOMPRESS_LITERALS,
+	SDTP_DECOMPRESS_OFFSET_LOW,
+	SDTP_DECOMPRESS_OFFSET_HIGH,
+	SDTP_DECOMPRESS_MATCH_LEN,
+	SDTP_DECOMPRESS_DONE,
+	SDTP_DECOMPRESS_ERROR
+};
+
+// Unaligned 4-byte load
+static uint32_t sdtp_compress_read32(const uint8_t* source) {
+	uint32_t value;
+	memcpy(&value, source, sizeof(value));
+
+	return value;
+}
+
+// Match finder slot of 4 bytes (Knuth multiplicative hash)
+static size_t sdtp_compress_hash(const uint32_t sequence) {
+	return (size_t)((sequence * 2654435761u) >> 22) & (SDTP_COMPRESS_TABLE_SIZE - 1);
+}
+
+// Writes length continuation bytes (false - no room)
+static bool sdtp_compress_length(uint8_t* dest, size_t* out, const size_t dest_capacity, size_t length) {
+	while (length >= 255) {
+		if (*out == dest_capacity) return false;
+		dest[(*out)++] = 255;
+		length -= 255;
+	}
+
+	if (*out == dest_capacity) return false;
+	dest[(*out)++] = (uint8_t)length;
+
+	return true;
+}
+
+// Writes a sequence, match_len 0 - last sequence with literals only (false - no room)
+static bool sdtp_compress_sequence(uint8_t* dest, size_t* out, const size_t dest_capacity, const uint8_t* literals,
+                                   const size_t literal_len, const size_t offset, const size_t match_len) {
+	const size_t literal_code = literal_len < 15 ? literal_len : 15;
+	const size_t match_code = match_len == 0 ? 0 : (match_len - SDTP_COMPRESS_MIN_MATCH < 15 ? match_len - SDTP_COMPRESS_MIN_MATCH : 15);
+
+	if (*out == dest_capacity) return false;
+	dest[(*out)++] = (uint8_t)(literal_code << 4 | match_code);
+
+	if (literal_code == 15 && !sdtp_compress_length(dest, out, dest_capacity, literal_len - 15)) return false;
+
+	if (literal_len > dest_capacity - *out) return false;
+	memcpy(dest + *out, literals, literal_len);
+	*out += literal_len;
+
+	if (match_len == 0) return true;
+
+	if (dest_capacity - *out < 2) return false;
+	dest[(*out)++] = (uint8_t)(offset & 0xFF);
+	dest[(*out)++] = (uint8_t)(offset >> 8);
+
+	if (match_code == 15 && !sdtp_compress_length(dest, out, dest_capacity, match_len - SDTP_COMPRESS_MIN_MATCH - 15)) {
+		return false;
+	}
+
+	return true;
+}
+
+size_t sdtp_compress(const uint8_t* source, const size_t source_len, uint8_t* dest, const size_t dest_capacity,
+                     uint32_t* table) {
+	if (!source || !dest || !table || source_len == 0) return 0;
+
+	// Entries are position + 1, zero is empty
+	memset(table, 0, SDTP_COMPRESS_TABLE_SIZE * sizeof(uint32_t));
+
+	size_t out = 0;
+	size_t anchor = 0;
+	size_t pos = 0;
+
+	// Greedy: take the first match the table remembers
+	while (source_len - pos >= SDTP_COMPRESS_MIN_MATCH) {
+		const uint32_t sequence = sdtp_compress_read32(source + pos);
+		const size_t slot = sdtp_compress_hash(sequence);
+		const size_t candidate = table[slot];
+		table[slot] = (uint32_t)(pos + 1);
+
+		if (candidate == 0 || pos - (candidate - 1) > SDTP_COMPRESS_MAX_OFFSET ||
+		    sdtp_compress_read32(source + candidate - 1) != sequence) {
+			pos++;
+			continue;
+		}
+
+		const size_t ref = candidate - 1;
+		size_t match_len = SDTP_COMPRESS_MIN_MATCH;
+		while (pos + match_len < source_len && source[ref + match_len] == source[pos + match_len]) {
+			match_len++;
+		}
+
+		if (!sdtp_compress_sequence(dest, &out, dest_capacity, source + anchor, pos - anchor, pos - ref, match_len)) {
+			return 0;
+		}
+
+		pos += match_len;
+		anchor = pos;
+	}
+
+	// Tail which didn't match goes as literals
+	if (anchor < source_len &&
+	    !sdtp_compress_sequence(dest, &out, dest_capacity, source + anchor, source_len - anchor, 0, 0)) {
+		return 0;
+	}
+
+	return out;
+}
+
+void sdtp_decompressor_init(sdtp_decompressor_t* decompressor, uint8_t* out, const size_t out_size) {
+	if (!decompressor) return;
+
+	decompressor->out = out;
+	decompressor->out_size = out_size;
+	decompressor->out_pos = 0;
+	decompressor->state = out_size == 0 ? SDTP_DECOMPRESS_DONE : SDTP_DECOMPRESS_TOKEN;
+	decompressor->literal = 0;
+	decompressor->match = 0;
+	decompressor->offset = 0;
+}
+
+// Moves on once literals are copied: the stream ends when the payload is full
+static void sdtp_decompressor_literals_done(sdtp_decompressor_t* decompressor) {
+	decompressor->state = decompressor->out_pos == decompressor->out_size ? SDTP_DECOMPRESS_DONE
+	                                                                      : SDTP_DECOMPRESS_OFFSET_LOW;
+}
+
+// Copies a match from the decoded payload
+static void sdtp_decompressor_copy_match(sdtp_decompressor_t* decompressor) {
+	if (decompressor->match > decompressor->out_size - decompressor->out_pos) {
+		decompressor->state = SDTP_DECOMPRESS_ERROR;
+		return;
+	}
+
+	// Byte by byte: a match may overlap itself to repeat a pattern
+	uint8_t* out = decompressor->out + decompressor->out_pos;
+	const uint8_t* ref = out - decompressor->offset;
+	for (size_t i = 0; i < decompressor->match; ++i) {
+		out[i] = ref[i];
+	}
+	decompressor->out_pos += decompressor->match;
+
+	decompressor->state = decompressor->out_pos == decompressor->out_size ? SDTP_DECOMPRESS_DONE
+	                                                                      : SDTP_DECOMPRESS_TOKEN;
+}
+
+bool sdtp_decompressor_update(sdtp_decompressor_t* decompressor, const uint8_t* input, const size_t input_len) {
+	if (!decompressor || (!input && input_len > 0)) return false;
+
+	size_t i = 0;
+	while (i < input_len) {
+		switch (decompressor->state) {
+			case SDTP_DECOMPRESS_TOKEN: {
+				const uint8_t token = input[i++];
+				decompressor->literal = token >> 4;
+				decompressor->match = (size_t)(token & 0x0F) + SDTP_COMPRESS_MIN_MATCH;
+
+				if (decompressor->literal == 15) {
+					decompressor->state = SDTP_DECOMPRESS_LITERAL_LEN;
+				} else if (decompressor->literal > 0) {
+					decompressor->state = SDTP_DECOMPRESS_LITERALS;
+				} else {
+					sdtp_decompressor_literals_done(decompressor);
+				}
+				break;
+			}
+
+			case SDTP_DECOMPRESS_LITERAL_LEN: {
+				const uint8_t length = input[i++];
+				decompressor->literal += length;
+
+				// Longer than the payload can't be right
+				if (decompressor->literal > decompressor->out_size - decompressor->out_pos) {
+					decompressor->state = SDTP_DECOMPRESS_ERROR;
+				} else if (length != 255) {
+					decompressor->state = SDTP_DECOMPRESS_LITERALS;
+				}
+				break;
+			}
+
+			case SDTP_DECOMPRESS_LITERALS: {
+				size_t take = input_len - i;
+				if (take > decompressor->literal) take = decompressor->literal;
+				if (take > decompressor->out_size - decompressor->out_pos) {
+					decompressor->state = SDTP_DECOMPRESS_ERROR;
+					break;
+				}
+
+				memcpy(decompressor->out + decompressor->out_pos, input + i, take);
+				decompressor->out_pos += take;
+				decompressor->literal -= take;
+				i += take;
+
+				if (decompressor->literal == 0) sdtp_decompressor_literals_done(decompressor);
+				break;
+			}
+
+			case SDTP_DECOMPRESS_OFFSET_LOW:
+				decompressor->offset = input[i++];
+				decompressor->state = SDTP_DECOMPRESS_OFFSET_HIGH;
+				break;
+
+			case SDTP_DECOMPRESS_OFFSET_HIGH:
+				decompressor->offset |= (size_t)input[i++] << 8;
+
+				// Match must start inside what is already decoded
+				if (decompressor->offset == 0 || decompressor->offset > decompressor->out_pos) {
+					decompressor->state = SDTP_DECOMPRESS_ERROR;
+				} else if (decompressor->match == 15 + SDTP_COMPRESS_MIN_MATCH) {
+					decompressor->state = SDTP_DECOMPRESS_MATCH_LEN;
+				} else {
+					sdtp_decompressor_copy_match(decompressor);
+				}
+				break;
+
+			case SDTP_DECOMPRESS_MATCH_LEN: {
+				const uint8_t length = input[i++];
+				decompressor->match += length;
+
+				if (decompressor->match > decompressor->out_size - decompressor->out_pos) {
+					decompressor->state = SDTP_DECOMPRESS_ERROR;
+				} else if (length != 255) {
+					sdtp_decompressor_copy_match(decompressor);
+				}
+				break;
+			}
+
+			// Input past the end of the payload
+			default:
+				decompressor->state = SDTP_DECOMPRESS_ERROR;
+				return false;
+		}
+	}
+
+	return decompressor->state != SDTP_DECOMPRESS_ERROR;
+}
+
+bool sdtp_decompressor_done(const sdtp_decompressor_t* decompressor) {
+	return decompressor && decompressor->state == SDTP_DECOMPRESS_DONE;
+}
+
+sdtp_packet_t* sdtp_decompress_packet(const sdtp_allocator_t* allocator, const sdtp_packet_view_t* view,
+                                      const size_t max_size) {
+	if (!view || !(view->header.type & SDTP_TYPE_COMPRESSED)) return NULL;
+	if (view->header.data_size < SDTP_COMPRESS_PREFIX_SIZE) return NULL;
+
+	uint32_t size;
+	memcpy(&size, view->body, SDTP_COMPRESS_PREFIX_SIZE);
+
+	// Size comes from the peer, don't let it pick the allocation
+	const size_t stream_len = view->header.data_size - SDTP_COMPRESS_PREFIX_SIZE;
+	if (max_size > 0 && size > max_size) return NULL;
+	if ((uint64_t)size > (uint64_t)stream_len * SDTP_COMPRESS_MAX_RATIO) return NULL;
+
+	sdtp_packet_t* packet = sdtp_packet_alloc(allocator, size);
+	if (!packet) return NULL;
+
+	sdtp_decompressor_t decompressor;
+	sdtp_decompressor_init(&decompressor, packet->body, size);
+	if (!sdtp_decompressor_update(&decompressor, view->body + SDTP_COMPRESS_PREFIX_SIZE, stream_len) ||
+	    !sdtp_decompressor_done(&decompressor)) {
+		sdtp_packet_free(packet);
+		return NULL;
+	}
+
+	packet->header.id = view->header.id;
+	packet->header.type = view->header.type & ~SDTP_TYPE_COMPRESSED;
+	packet->header.checksum = 0;
+
+	return packet;
+}
+
+bool sdtp_instance_set_compression(sdtp_instance_t* instance, const bool enabled, uint8_t* storage) {
+	if (!instance) return false;
+
+	sdtp_compression_t* compression = &instance->compression;
+	const size_t storage_size = SDTP_COMPRESS_STORAGE_SIZE(instance->config.buffer_size);
+
+	if (compression->owns_storage) {
+		sdtp_allocator_free(instance->config.allocator, compression->storage, storage_size);
+	}
+	compression->enabled = false;
+	compression->storage = NULL;
+	compression->owns_storage = false;
+
+	if (!enabled) return true;
+
+	if (!storage) {
+		storage = (uint8_t*)sdtp_allocator_alloc(instance->config.allocator, storage_size);
+		if (!storage) return false;
+		compression->owns_storage = true;
+	}
+	compression->storage = storage;
+	compression->enabled = true;
+
+	return true;
+}
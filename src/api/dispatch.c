@@ -0,0 +1,246 @@
+// Copyright (c) 2026 bazelik
+
+#include <api/libsdtp.h>
+
+#include <string.h>
+
+// Finds handler of a packet type (NULL - none)
+static const sdtp_handler_entry_t* sdtp_dispatch_find(const sdtp_dispatch_table_t* table, const uint32_t packet_type) {
+	// Flags don't change the handler
+	const uint32_t type = SDTP_TYPE_BASE(packet_type);
+
+	// Built-in types are a direct lookup
+	if (type < SDTP_DISPATCH_TYPE_COUNT && table->types[type].handler) return &table->types[type];
+
+	for (size_t i = 0; i < table->range_count; ++i) {
+		const sdtp_handler_range_t* range = &table->ranges[i];
+		if (type >= range->first && type <= range->last) return &range->entry;
+	}
+
+	if (table->fallback.handler) return &table->fallback;
+
+	return NULL;
+}
+
+// Features this end accepts
+static uint32_t sdtp_link_local_features(const sdtp_instance_t* instance) {
+	uint32_t features = 0;
+	if (instance->compression.enabled) features |= SDTP_FEATURE_COMPRESSION;
+	if (instance->compact_header) features |= SDTP_FEATURE_COMPACT_HEADER;
+
+	return features;
+}
+
+// Sends a handshake advertising local features
+static bool sdtp_link_handshake(sdtp_instance_t* instance, const uint32_t packet_id, const bool reply) {
+	const uint32_t features = sdtp_link_local_features(instance) | (reply ? SDTP_HANDSHAKE_REPLY : 0u);
+	const sdtp_iovec_t body = { (const uint8_t*)&features, sizeof(features) };
+
+	return sdtp_write_packet_iov(instance, &body, 1, SDTP_HANDSHAKE, packet_id);
+}
+
+// Keeps link state from control packets
+static void sdtp_dispatch_control(sdtp_instance_t* instance, const sdtp_packet_view_t* view) {
+	sdtp_link_t* link = &instance->link;
+
+	switch (view->header.type) {
+		case SDTP_HANDSHAKE: {
+			// Peers without features send an empty body, which is a request
+			uint32_t features = 0;
+			if (view->header.data_size >= sizeof(uint32_t)) memcpy(&features, view->body, sizeof(uint32_t));
+
+			if (features & SDTP_HANDSHAKE_REPLY) {
+				// Replies are never answered, a stray one doesn't bring the link up
+				if (link->state == SDTP_LINK_DOWN) break;
+			} else {
+				// Every request is answered, so the peer repairs a lost reply by asking again
+				if (!sdtp_link_handshake(instance, view->header.id, true)) break;
+
+				// Peer restarted its sequences too
+				sdtp_reliable_reset(instance);
+			}
+			link->peer_features = features & ~SDTP_HANDSHAKE_REPLY;
+			link->state = SDTP_LINK_UP;
+			break;
+		}
+
+		case SDTP_DISCONNECT:
+			link->state = SDTP_LINK_DOWN;
+			link->peer_features = 0;
+			break;
+
+		case SDTP_ERROR:
+			link->errors++;
+			link->last_error_id = view->header.id;
+			break;
+
+		default:
+			break;
+	}
+}
+
+bool sdtp_set_handler(sdtp_instance_t* instance, const sdtp_packet_type_t packet_type,
+                      const sdtp_packet_handler_t handler, void* ctx) {
+	if (!instance) return false;
+	if ((uint32_t)packet_type >= SDTP_DISPATCH_TYPE_COUNT) return false;
+
+	instance->dispatch.types[packet_type] = (sdtp_handler_entry_t){ handler, handler ? ctx : NULL };
+
+	return true;
+}
+
+bool sdtp_set_range_handler(sdtp_instance_t* instance, const uint32_t first, const uint32_t last,
+                            const sdtp_packet_handler_t handler, void* ctx) {
+	if (!instance || first > last) return false;
+
+	sdtp_dispatch_table_t* table = &instance->dispatch;
+
+	// Replace or remove a range with the same bounds
+	for (size_t i = 0; i < table->range_count; ++i) {
+		sdtp_handler_range_t* range = &table->ranges[i];
+		if (range->first != first || range->last != last) continue;
+
+		if (handler) {
+			range->entry = (sdtp_handler_entry_t){ handler, ctx };
+			return true;
+		}
+
+		// Keep registration order of the remaining ranges
+		for (size_t j = i + 1; j < table->range_count; ++j) {
+			table->ranges[j - 1] = table->ranges[j];
+		}
+		table->range_count--;
+		return true;
+	}
+
+	// Nothing to remove
+	if (!handler) return false;
+	if (table->range_count == SDTP_DISPATCH_MAX_RANGES) return false;
+
+	table->ranges[table->range_count++] = (sdtp_handler_range_t){ first, last, { handler, ctx } };
+
+	return true;
+}
+
+void sdtp_set_fallback_handler(sdtp_instance_t* instance, const sdtp_packet_handler_t handler, void* ctx) {
+	if (!instance) return;
+
+	instance->dispatch.fallback = (sdtp_handler_entry_t){ handler, handler ? ctx : NULL };
+}
+
+bool sdtp_dispatch_view(sdtp_instance_t* instance, const sdtp_packet_view_t* view) {
+	if (!instance || !view) return false;
+
+	// Fragments are held back until their payload completes
+	if (instance->reassembly.enabled && (view->header.type & SDTP_TYPE_FRAGMENT)) {
+		sdtp_packet_t* packet = sdtp_reassembly_insert(instance, view);
+		if (!packet) return true;
+
+		const sdtp_packet_view_t whole = { packet->header, packet->body, 0 };
+		const bool handled = sdtp_dispatch_view(instance, &whole);
+		sdtp_packet_free(packet);
+
+		return handled;
+	}
+
+	// Fragments without reassembly go to handlers as they are
+	const uint32_t layers = view->header.type & (SDTP_TYPE_FRAGMENT | SDTP_TYPE_COMPRESSED | SDTP_TYPE_RELIABLE);
+
+	// Compression is the outermost layer after fragmentation
+	if ((layers & ~SDTP_TYPE_RELIABLE) == SDTP_TYPE_COMPRESSED) {
+		// Only peers that negotiated compression may send it, payloads are never larger than a buffer
+		if (!(sdtp_link_get_features(instance) & SDTP_FEATURE_COMPRESSION)) return false;
+
+		sdtp_packet_t* packet = sdtp_decompress_packet(instance->config.allocator, view, instance->config.buffer_size);
+		if (!packet) return false;
+
+		const sdtp_packet_view_t whole = { packet->header, packet->body, 0 };
+		const bool handled = sdtp_dispatch_view(instance, &whole);
+		sdtp_packet_free(packet);
+
+		return handled;
+	}
+
+	// Acks, duplicates and early frames stop here, reliable frames go on without their sequence
+	if (instance->reliable.enabled &&
+	    (layers == SDTP_TYPE_RELIABLE || (layers == 0 && SDTP_TYPE_BASE(view->header.type) == SDTP_ACK))) {
+		sdtp_packet_view_t inner;
+		if (!sdtp_reliable_receive(instance, view, &inner)) return true;
+
+		const bool handled = sdtp_dispatch_view(instance, &inner);
+
+		// Frames which arrived early follow the one they waited for
+		sdtp_packet_t* packet;
+		while ((packet = sdtp_reliable_take_held(instance)) != NULL) {
+			const sdtp_packet_view_t whole = { packet->header, packet->body, 0 };
+			sdtp_dispatch_view(instance, &whole);
+			sdtp_packet_free(packet);
+		}
+
+		return handled;
+	}
+
+	sdtp_dispatch_control(instance, view);
+
+	const sdtp_handler_entry_t* entry = sdtp_dispatch_find(&instance->dispatch, view->header.type);
+	if (!entry) {
+		instance->dispatch.unhandled++;
+		return false;
+	}
+
+	entry->handler(instance, view, entry->ctx);
+
+	return true;
+}
+
+size_t sdtp_dispatch(sdtp_instance_t* instance) {
+	if (!instance) return 0;
+
+	// Views are released right after their handler, so input space is reclaimed as we go
+	size_t count = 0;
+	sdtp_packet_view_t view;
+	while (sdtp_read_packet_view(instance, &view)) {
+		sdtp_dispatch_view(instance, &view);
+		sdtp_packet_view_release(instance, &view);
+		count++;
+	}
+
+	// Acknowledge what was read, repair what the peer missed
+	sdtp_reliable_poll(instance);
+
+	return count;
+}
+
+bool sdtp_link_connect(sdtp_instance_t* instance, const uint32_t packet_id) {
+	if (!instance) return false;
+
+	if (!sdtp_link_handshake(instance, packet_id, false)) return false;
+
+	// Peer restarts its sequences on every request, established links stay up
+	sdtp_reliable_reset(instance);
+	if (instance->link.state == SDTP_LINK_DOWN) instance->link.state = SDTP_LINK_CONNECTING;
+
+	return true;
+}
+
+bool sdtp_link_disconnect(sdtp_instance_t* instance, const uint32_t packet_id) {
+	if (!instance) return false;
+
+	// Link is down even if the peer never hears about it
+	instance->link.state = SDTP_LINK_DOWN;
+	instance->link.peer_features = 0;
+
+	return sdtp_write_packet_iov(instance, NULL, 0, SDTP_DISCONNECT, packet_id);
+}
+
+sdtp_link_state_t sdtp_link_get_state(const sdtp_instance_t* instance) {
+	if (!instance) return SDTP_LINK_DOWN;
+
+	return instance->link.state;
+}
+
+uint32_t sdtp_link_get_features(const sdtp_instance_t* instance) {
+	if (!instance || instance->link.state != SDTP_LINK_UP) return 0;
+
+	return sdtp_link_local_features(instance) & instance->link.peer_features;
+}
@@ -0,0 +1,195 @@
+// Copyright (c) 2026 bazelik
+
+#include <api/libsdtp.h>
+
+#include <string.h>
+
+// Frees payload of a slot
+static void sdtp_reassembly_drop(sdtp_reassembly_t* reassembly, sdtp_reassembly_slot_t* slot) {
+	reassembly->used_bytes -= slot->packet->header.data_size;
+	sdtp_packet_free(slot->packet);
+
+	slot->packet = NULL;
+	slot->used = false;
+}
+
+// Finds slot of a payload or takes a free one (NULL - no room)
+static sdtp_reassembly_slot_t* sdtp_reassembly_slot(sdtp_instance_t* instance, const uint32_t id, const uint32_t type,
+                                                   const uint32_t total) {
+	sdtp_reassembly_t* reassembly = &instance->reassembly;
+
+	sdtp_reassembly_slot_t* free_slot = NULL;
+	for (size_t i = 0; i < SDTP_REASSEMBLY_SLOTS; ++i) {
+		sdtp_reassembly_slot_t* slot = &reassembly->slots[i];
+
+		if (!slot->used) {
+			if (!free_slot) free_slot = slot;
+			continue;
+		}
+
+		// Fragments of a payload must agree on its size and type
+		if (slot->id == id) {
+			const sdtp_packet_header_t* header = &slot->packet->header;
+			return header->data_size == total && header->type == type ? slot : NULL;
+		}
+	}
+
+	// Unfinished payloads keep their memory
+	if (!free_slot || total > reassembly->config.max_bytes - reassembly->used_bytes) return NULL;
+
+	sdtp_packet_t* packet = sdtp_packet_alloc(instance->config.allocator, total);
+	if (!packet) return NULL;
+
+	packet->header.id = id;
+	packet->header.data_size = total;
+	packet->header.type = type;
+	packet->header.checksum = 0;
+
+	free_slot->used = true;
+	free_slot->id = id;
+	free_slot->packet = packet;
+	free_slot->range_count = 0;
+	free_slot->started = sdtp_instance_now(instance);
+	reassembly->used_bytes += total;
+
+	return free_slot;
+}
+
+// Adds [start, end) to the received ranges (false - too many ranges)
+static bool sdtp_reassembly_add_range(sdtp_reassembly_slot_t* slot, uint32_t start, uint32_t end) {
+	sdtp_range_t ranges[SDTP_REASSEMBLY_MAX_RANGES + 1];
+	size_t count = 0;
+
+	// Keep ranges before and after as they are, merge the ones touching the new one
+	size_t i = 0;
+	while (i < slot->range_count && slot->ranges[i].end < start) {
+		ranges[count++] = slot->ranges[i++];
+	}
+	while (i < slot->range_count && slot->ranges[i].start <= end) {
+		if (slot->ranges[i].start < start) start = slot->ranges[i].start;
+		if (slot->ranges[i].end > end) end = slot->ranges[i].end;
+		i++;
+	}
+	ranges[count++] = (sdtp_range_t){ start, end };
+	while (i < slot->range_count) {
+		ranges[count++] = slot->ranges[i++];
+	}
+
+	if (count > SDTP_REASSEMBLY_MAX_RANGES) return false;
+
+	memcpy(slot->ranges, ranges, count * sizeof(ranges[0]));
+	slot->range_count = count;
+
+	return true;
+}
+
+bool sdtp_instance_set_reassembly(sdtp_instance_t* instance, const sdtp_reassembly_config_t* config) {
+	if (!instance) return false;
+
+	sdtp_reassembly_t* reassembly = &instance->reassembly;
+
+	// Unfinished payloads can't be completed under different settings
+	for (size_t i = 0; i < SDTP_REASSEMBLY_SLOTS; ++i) {
+		if (reassembly->slots[i].used) sdtp_reassembly_drop(reassembly, &reassembly->slots[i]);
+	}
+
+	if (!config) {
+		reassembly->enabled = false;
+		return true;
+	}
+	if (config->max_bytes == 0) return false;
+
+	reassembly->config = *config;
+	reassembly->enabled = true;
+
+	return true;
+}
+
+sdtp_packet_t* sdtp_reassembly_insert(sdtp_instance_t* instance, const sdtp_packet_view_t* view) {
+	if (!instance || !view) return NULL;
+
+	sdtp_reassembly_t* reassembly = &instance->reassembly;
+	if (!reassembly->enabled || !(view->header.type & SDTP_TYPE_FRAGMENT)) return NULL;
+
+	// Stale payloads free their slots first
+	sdtp_reassembly_expire(instance);
+
+	// Fragment carries a part of the payload, never an empty one
+	if (view->header.data_size <= SDTP_FRAGMENT_PREFIX_SIZE) {
+		reassembly->dropped++;
+		return NULL;
+	}
+
+	uint32_t prefix[2];
+	memcpy(prefix, view->body, SDTP_FRAGMENT_PREFIX_SIZE);
+	const uint32_t total = prefix[0];
+	const uint32_t offset = prefix[1];
+	const uint32_t len = view->header.data_size - (uint32_t)SDTP_FRAGMENT_PREFIX_SIZE;
+
+	if (offset > total || len > total - offset) {
+		reassembly->dropped++;
+		return NULL;
+	}
+
+	sdtp_reassembly_slot_t* slot = sdtp_reassembly_slot(instance, view->header.id, view->header.type & ~SDTP_TYPE_FRAGMENT, total);
+	if (!slot || !sdtp_reassembly_add_range(slot, offset, offset + len)) {
+		reassembly->dropped++;
+		return NULL;
+	}
+
+	// Duplicates overwrite the same bytes
+	memcpy(slot->packet->body + offset, view->body + SDTP_FRAGMENT_PREFIX_SIZE, len);
+
+	// Complete once a single range covers the payload
+	if (slot->range_count != 1 || slot->ranges[0].start != 0 || slot->ranges[0].end != total) return NULL;
+
+	sdtp_packet_t* packet = slot->packet;
+	reassembly->used_bytes -= total;
+	slot->packet = NULL;
+	slot->used = false;
+
+	return packet;
+}
+
+uint64_t sdtp_reassembly_next_timeout(const sdtp_instance_t* instance) {
+	if (!instance) return UINT64_MAX;
+
+	const sdtp_reassembly_t* reassembly = &instance->reassembly;
+	if (reassembly->config.timeout_us == 0) return UINT64_MAX;
+
+	const uint64_t now = sdtp_instance_now(instance);
+
+	// Oldest payload expires first
+	uint64_t timeout = UINT64_MAX;
+	for (size_t i = 0; i < SDTP_REASSEMBLY_SLOTS; ++i) {
+		const sdtp_reassembly_slot_t* slot = &reassembly->slots[i];
+		if (!slot->used) continue;
+
+		const uint64_t age = now - slot->started;
+		const uint64_t left = age < reassembly->config.timeout_us ? reassembly->config.timeout_us - age : 0;
+		if (left < timeout) timeout = left;
+	}
+
+	return timeout;
+}
+
+size_t sdtp_reassembly_expire(sdtp_instance_t* instance) {
+	if (!instance) return 0;
+
+	sdtp_reassembly_t* reassembly = &instance->reassembly;
+	if (reassembly->config.timeout_us == 0) return 0;
+
+	const uint64_t now = sdtp_instance_now(instance);
+
+	size_t expired = 0;
+	for (size_t i = 0; i < SDTP_REASSEMBLY_SLOTS; ++i) {
+		sdtp_reassembly_slot_t* slot = &reassembly->slots[i];
+		if (!slot->used || now - slot->started < reassembly->config.timeout_us) continue;
+
+		sdtp_reassembly_drop(reassembly, slot);
+		expired++;
+	}
+	reassembly->expired += expired;
+
+	return expired;
+}
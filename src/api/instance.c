@@ -2,25 +2,65 @@
 
 #include <api/libsdtp.h>
 
-#include <stdlib.h>
-#include <time.h>
+// Sets fields shared by all constructors, hooks and buffers are set by the caller
+static void sdtp_instance_setup(sdtp_instance_t* instance, const sdtp_config_t* config) {
+	// Pick checksum kernel for this CPU
+	sdtp_checksum_init();
 
-sdtp_instance_t* sdtp_instance_create(const sdtp_config_t* config, const sdtp_function_hooks* gpio_hooks) {
+	// Set config
+	instance->config = *config;
+
+	// No hooks yet
+	instance->function_hooks = NULL;
+	instance->hooks_v2 = NULL;
+
+	// Init parser
+	sdtp_parser_reset(&instance->parser);
+	instance->parser.compact = false;
+	instance->view_scratch = NULL;
+	instance->view_scratch_size = 0;
+
+	// No handlers, no handshake yet
+	instance->dispatch = (sdtp_dispatch_table_t){ 0 };
+	instance->link = (sdtp_link_t){ 0 };
+	instance->reassembly = (sdtp_reassembly_t){ 0 };
+	instance->fragment_progress = (sdtp_fragment_progress_t){ 0 };
+	instance->reliable = (sdtp_reliable_t){ 0 };
+	instance->compression = (sdtp_compression_t){ 0 };
+	instance->header_format = (sdtp_header_format_t){ 0 };
+	instance->compact_header = false;
+
+	// Default clock, no coalescing
+	instance->clock = sdtp_default_clock;
+	instance->clock_ctx = NULL;
+	instance->coalesce = (sdtp_coalesce_config_t){ 0 };
+	instance->pending_since = 0;
+
+	// No output queue
+	instance->output_queue = NULL;
+
+	// Single output class until priorities are set, control packets go first once they are
+	instance->scheduler = (sdtp_scheduler_t){ 0 };
+	instance->scheduler.type_priority[SDTP_HANDSHAKE] = SDTP_PRIORITY_HIGH;
+	instance->scheduler.type_priority[SDTP_DISCONNECT] = SDTP_PRIORITY_HIGH;
+	instance->scheduler.type_priority[SDTP_ERROR] = SDTP_PRIORITY_HIGH;
+	instance->scheduler.type_priority[SDTP_DATA_PACKET] = SDTP_PRIORITY_NORMAL;
+	instance->scheduler.type_priority[SDTP_ACK] = SDTP_PRIORITY_HIGH;
+}
+
+// Allocates instance with buffers
+static sdtp_instance_t* sdtp_instance_allocate(const sdtp_config_t* config) {
 	if (!config) return NULL;
 	if (config->buffer_size == 0) return NULL;
-	if (!gpio_hooks) return NULL;
 
 	// Allocate an instance
-	sdtp_instance_t* instance = (sdtp_instance_t*)malloc(sizeof(*instance));
+	sdtp_instance_t* instance = (sdtp_instance_t*)sdtp_allocator_alloc(config->allocator, sizeof(*instance));
 	if (!instance) return NULL;
 
-	// Set config
-	instance->config = *config;
-
-	// Set hooks
-	instance->function_hooks = gpio_hooks;
+	sdtp_instance_setup(instance, config);
 
 	// Allocate buffers
+	instance->owns_memory = true;
 	instance->input_buffer = sdtp_buffer_create(config);
 	instance->output_buffer = sdtp_buffer_create(config);
 
@@ -28,22 +68,165 @@ sdtp_instance_t* sdtp_instance_create(const sdtp_config_t* config, const sdtp_fu
 	if (!instance->input_buffer || !instance->output_buffer) {
 		sdtp_buffer_free(instance->input_buffer);
 		sdtp_buffer_free(instance->output_buffer);
-		free(instance);
+		sdtp_allocator_free(config->allocator, instance, sizeof(*instance));
 
 		return NULL;
 	}
+	sdtp_buffer_set_concurrent(instance->input_buffer, config->concurrent_input);
+
+	return instance;
+}
+
+// Sets instance up on caller memory
+static bool sdtp_instance_place(sdtp_instance_t* instance, const sdtp_config_t* config,
+                                uint8_t* in_storage, uint8_t* out_storage) {
+	if (!instance || !config) return false;
+	if (!in_storage || !out_storage) return false;
+
+	// Storage size is derived from buffer_size, so it must be used as is
+	const size_t buffer_size = config->buffer_size;
+	if (buffer_size == 0 || (buffer_size & (buffer_size - 1)) != 0) return false;
+
+	sdtp_instance_setup(instance, config);
+
+	// Wrapped views are copied right after the input ring
+	instance->view_scratch = in_storage + buffer_size;
+	instance->view_scratch_size = buffer_size;
+
+	// Buffers live inside the instance
+	instance->owns_memory = false;
+	sdtp_buffer_init(&instance->buffers[SDTP_INPUT_BUFFER], in_storage, buffer_size);
+	sdtp_buffer_init(&instance->buffers[SDTP_OUTPUT_BUFFER], out_storage, buffer_size);
+	instance->input_buffer = &instance->buffers[SDTP_INPUT_BUFFER];
+	instance->output_buffer = &instance->buffers[SDTP_OUTPUT_BUFFER];
+	sdtp_buffer_set_concurrent(instance->input_buffer, config->concurrent_input);
+
+	return true;
+}
+
+sdtp_instance_t* sdtp_instance_create(const sdtp_config_t* config, const sdtp_function_hooks* gpio_hooks) {
+	if (!gpio_hooks) return NULL;
+
+	sdtp_instance_t* instance = sdtp_instance_allocate(config);
+	if (!instance) return NULL;
+
+	// Set hooks
+	instance->function_hooks = gpio_hooks;
+
+	return instance;
+}
+
+sdtp_instance_t* sdtp_instance_create_v2(const sdtp_config_t* config, const sdtp_function_hooks_v2* hooks) {
+	if (!hooks) return NULL;
+
+	sdtp_instance_t* instance = sdtp_instance_allocate(config);
+	if (!instance) return NULL;
+
+	// Set hooks
+	instance->hooks_v2 = hooks;
 
 	return instance;
 }
 
+bool sdtp_instance_init(sdtp_instance_t* instance, const sdtp_config_t* config, const sdtp_function_hooks* gpio_hooks,
+                        uint8_t* in_storage, uint8_t* out_storage) {
+	if (!gpio_hooks) return false;
+	if (!sdtp_instance_place(instance, config, in_storage, out_storage)) return false;
+
+	// Set hooks
+	instance->function_hooks = gpio_hooks;
+
+	return true;
+}
+
+bool sdtp_instance_init_v2(sdtp_instance_t* instance, const sdtp_config_t* config, const sdtp_function_hooks_v2* hooks,
+                           uint8_t* in_storage, uint8_t* out_storage) {
+	if (!hooks) return false;
+	if (!sdtp_instance_place(instance, config, in_storage, out_storage)) return false;
+
+	// Set hooks
+	instance->hooks_v2 = hooks;
+
+	return true;
+}
+
 void sdtp_instance_close(sdtp_instance_t* instance) {
 	if (!instance) return;
 
+	// Don't lose queued and coalesced output
+	sdtp_flush_queue(instance);
+	sdtp_flush(instance);
+
+	// Class queues, unfinished payloads and scratch areas are allocated even on caller memory
+	sdtp_instance_set_priorities(instance, NULL, NULL);
+	sdtp_instance_set_reassembly(instance, NULL);
+	sdtp_instance_set_reliable(instance, NULL, NULL);
+	sdtp_instance_set_compression(instance, false, NULL);
+
+	// Memory belongs to the caller
+	if (!instance->owns_memory) {
+		instance->view_scratch = NULL;
+		instance->input_buffer = NULL;
+		instance->output_buffer = NULL;
+		return;
+	}
+
+	const sdtp_allocator_t* allocator = instance->config.allocator;
+
+	if (instance->view_scratch) sdtp_allocator_free(allocator, instance->view_scratch, instance->view_scratch_size);
+	instance->view_scratch = NULL;
+
 	sdtp_buffer_free(instance->input_buffer);
 	instance->input_buffer = NULL;
 	sdtp_buffer_free(instance->output_buffer);
 	instance->output_buffer = NULL;
 
-	free(instance);
+	sdtp_allocator_free(allocator, instance, sizeof(*instance));
 	instance = NULL;
 }
+
+void sdtp_instance_set_clock(sdtp_instance_t* instance, const sdtp_clock_t clock, void* ctx) {
+	if (!instance) return;
+
+	instance->clock = clock ? clock : sdtp_default_clock;
+	instance->clock_ctx = ctx;
+}
+
+uint64_t sdtp_instance_now(const sdtp_instance_t* instance) {
+	if (!instance || !instance->clock) return sdtp_default_clock(NULL);
+
+	return instance->clock(instance->clock_ctx);
+}
+
+void sdtp_instance_set_coalescing(sdtp_instance_t* instance, const sdtp_coalesce_config_t* coalesce) {
+	if (!instance) return;
+
+	if (!coalesce || !coalesce->enabled) {
+		instance->coalesce = (sdtp_coalesce_config_t){ 0 };
+		sdtp_flush(instance);
+		return;
+	}
+
+	instance->coalesce = *coalesce;
+	instance->pending_since = sdtp_instance_now(instance);
+}
+
+bool sdtp_instance_set_header_format(sdtp_instance_t* instance, const sdtp_header_format_t* format) {
+	if (!instance) return false;
+
+	if (!format) {
+		instance->compact_header = false;
+		return true;
+	}
+
+	// Sizes must have a compact code, checksum can't be empty (ids that don't fit use the full header)
+	const size_t id_size = format->id_size;
+	const size_t checksum_size = format->checksum_size;
+	if (id_size != 0 && id_size != 1 && id_size != 2 && id_size != 4) return false;
+	if (checksum_size != 1 && checksum_size != 2 && checksum_size != 4) return false;
+
+	instance->header_format = *format;
+	instance->compact_header = true;
+
+	return true;
+}
@@ -1,54 +1,152 @@
 // Copyright (c) 2026 bazelik-null
 
-#include <stdlib.h>
 #include <api/libsdtp.h>
 
 bool sdtp_io_write(sdtp_instance_t* instance) {
-	if (!instance || !instance->function_hooks->write) return false;
+	if (!instance) return false;
 
-	// Get used space of the input buffer
-	const size_t used_space = sdtp_buffer_get_used_space(instance->output_buffer);
+	const sdtp_function_hooks_v2* hooks = instance->hooks_v2;
+	if (hooks ? !hooks->writev : !instance->function_hooks || !instance->function_hooks->write) return false;
 
-	// Allocate tmp buffer
-	uint8_t* tmp_buffer = (uint8_t*)malloc(used_space);
-	if (!tmp_buffer) return false;
+	sdtp_buffer_t* buffer = instance->output_buffer;
+	if (sdtp_buffer_get_used_space(buffer) == 0) return false;
 
-	// Read buffer data
-	const size_t read = sdtp_buffer_read(instance->output_buffer, tmp_buffer, used_space, SDTP_READ_PARTIAL);
-	if (read == 0) {
-		free(tmp_buffer);
-		return false;
-	}
+	// Both spans go out in a single vectored call
+	if (hooks) {
+		sdtp_iovec_t iov[2];
+		size_t count = 0;
+		size_t total = 0;
+
+		size_t span_len = 0;
+		const uint8_t* span;
+		while (count < 2 && (span = sdtp_buffer_get_read_span(buffer, total, &span_len)) != NULL) {
+			iov[count].base = span;
+			iov[count].len = span_len;
+			total += span_len;
+			count++;
+		}
 
-	// Write tmp buffer via function hook
-	instance->function_hooks->write(tmp_buffer, read);
+		// Unwritten bytes stay for the next call
+		size_t written = hooks->writev(hooks->ctx, iov, count);
+		if (written > total) written = total;
+		sdtp_buffer_consume(buffer, written);
+
+		return true;
+	}
 
-	// Clean memory
-	free(tmp_buffer);
+	// Hand buffer spans to the hook directly (second span only if data wraps around)
+	size_t span_len = 0;
+	uint8_t* span;
+	while ((span = sdtp_buffer_get_span(buffer, 0, &span_len)) != NULL) {
+		instance->function_hooks->write(span, span_len);
+		sdtp_buffer_consume(buffer, span_len);
+	}
 
 	return true;
 }
 
+bool sdtp_io_push(sdtp_instance_t* instance, const uint8_t* data, const size_t len) {
+	if (!instance || !data || len == 0) return false;
+
+	sdtp_buffer_expand(instance->input_buffer, len);
+
+	return sdtp_buffer_push(instance->input_buffer, data, len) == len;
+}
+
+// Reads straight into the free space of the input buffer
+static bool sdtp_io_read_into(sdtp_instance_t* instance, const sdtp_function_hooks_v2* hooks) {
+	sdtp_buffer_t* buffer = instance->input_buffer;
+
+	// Full buffer waits for the consumer, unless it may grow for a large frame
+	sdtp_buffer_expand(buffer, 1);
+
+	// Fill the span up to the end of the memory, then the wrapped one
+	size_t total = 0;
+	size_t span_len = 0;
+	uint8_t* span;
+	while ((span = sdtp_buffer_get_write_span(buffer, &span_len)) != NULL) {
+		size_t read_len = hooks->read_into(hooks->ctx, span, span_len);
+		if (read_len == 0) break;
+		if (read_len > span_len) read_len = span_len;
+
+		sdtp_buffer_commit(buffer, read_len);
+		total += read_len;
+
+		// Channel has no more data for now
+		if (read_len < span_len) break;
+	}
+
+	return total > 0;
+}
+
 bool sdtp_io_read(sdtp_instance_t* instance) {
-	if (!instance || !instance->function_hooks->read) return false;
+	if (!instance) return false;
+
+	const sdtp_function_hooks_v2* hooks = instance->hooks_v2;
+	if (hooks) return hooks->read_into ? sdtp_io_read_into(instance, hooks) : false;
+
+	if (!instance->function_hooks || !instance->function_hooks->read) return false;
 
 	// Read data to tmp buffer via function hook
 	size_t read_len = 0;
 	uint8_t* tmp_buffer = instance->function_hooks->read(&read_len);
 	if (read_len == 0 || !tmp_buffer) {
-		if (tmp_buffer) free(tmp_buffer);
+		sdtp_allocator_free(NULL, tmp_buffer, read_len);
 		return false;
 	}
 
-	// Write data from tmp buffer to input buffer
+	// Write data from tmp buffer to input buffer (overflow policy decides what's kept)
 	const size_t written = sdtp_buffer_write(instance->input_buffer, tmp_buffer, read_len);
-	if (written != read_len) {
-		free(tmp_buffer);
-		return false;
+
+	// Clean memory (hook owns it with SDTP_NO_MALLOC)
+	sdtp_allocator_free(NULL, tmp_buffer, read_len);
+
+	// Hook can't take back the rest, a short write lost received bytes
+	return written == read_len;
+}
+
+size_t sdtp_output_pending(const sdtp_instance_t* instance) {
+	if (!instance) return 0;
+
+	return sdtp_buffer_get_used_space(instance->output_buffer) + sdtp_priority_pending(instance);
+}
+
+bool sdtp_flush(sdtp_instance_t* instance) {
+	if (!instance) return false;
+
+	// Class queues are emptied through the output buffer one buffer at a time
+	for (;;) {
+		sdtp_priority_schedule(instance);
+
+		// Nothing pending is not an error
+		if (sdtp_buffer_get_used_space(instance->output_buffer) == 0) return true;
+
+		if (!sdtp_io_write(instance)) return false;
+
+		// Busy channel, the rest waits for the next flush
+		if (sdtp_buffer_get_used_space(instance->output_buffer) > 0) return true;
 	}
+}
+
+bool sdtp_flush_due(sdtp_instance_t* instance) {
+	if (!instance) return false;
+
+	const size_t pending = sdtp_output_pending(instance);
+	if (pending == 0) return true;
 
-	// Clean memory
-	free(tmp_buffer);
+	// Without coalescing everything is due right away
+	const sdtp_coalesce_config_t* coalesce = &instance->coalesce;
+	if (!coalesce->enabled) return sdtp_flush(instance);
+
+	// Size threshold
+	const size_t threshold = coalesce->flush_threshold ? coalesce->flush_threshold : instance->output_buffer->size;
+	if (pending >= threshold) return sdtp_flush(instance);
+
+	// Latency deadline
+	if (coalesce->flush_deadline_us > 0) {
+		const uint64_t age = sdtp_instance_now(instance) - instance->pending_since;
+		if (age >= coalesce->flush_deadline_us) return sdtp_flush(instance);
+	}
 
 	return true;
-}
\ No newline at end of file
+}
@@ -1,9 +1,14 @@
 // Copyright (c) 2026 bazelik
 
+// clock_gettime() on POSIX systems
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
 #include <api/libsdtp.h>
 
-#include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 char* sdtp_get_char_data(const sdtp_packet_t* packet) {
 	if (packet == NULL) return NULL;
@@ -14,7 +19,7 @@ char* sdtp_get_char_data(const sdtp_packet_t* packet) {
 	if (body == NULL) return NULL;
 
 	// Allocate a buffer for a null-terminated string
-	char* body_buffer = (char*)malloc(packet->header.data_size + 1);
+	char* body_buffer = (char*)sdtp_allocator_alloc(NULL, packet->header.data_size + 1);
 	if (body_buffer == NULL) return NULL;
 
 	// Copy the bytes to a buffer
@@ -31,7 +36,7 @@ uint8_t* sdtp_char_to_bytes(const char* source, size_t* data_len) {
 
 	*data_len = strlen(source);
 
-	uint8_t* byte_buffer = (uint8_t*)malloc(*data_len);
+	uint8_t* byte_buffer = (uint8_t*)sdtp_allocator_alloc(NULL, *data_len);
 	if (byte_buffer == NULL) return NULL;
 
 	// Copy the bytes to a buffer
@@ -40,47 +45,16 @@ uint8_t* sdtp_char_to_bytes(const char* source, size_t* data_len) {
 	return byte_buffer;
 }
 
-// Adapted from Wikipedia's Fletcher checksum article
-// https://en.wikipedia.org/wiki/Fletcher%27s_checksum
-// Original content licensed under CC BY-SA
-uint32_t sdtp_calculate_fletcher32(const uint8_t *data, const size_t len)
-{
-	uint32_t c0, c1;
-	uint i;
-
-	size_t word_len = len / 2;
-
-	for (c0 = c1 = 0; word_len >= 360; word_len -= 360) {
-		for (i = 0; i < 360; ++i) {
-			uint16_t word;
-			memcpy(&word, data, sizeof(word));
-			data += 2;
-			c0 = c0 + word;
-			c1 = c1 + c0;
-		}
-		c0 = c0 % 65535;
-		c1 = c1 % 65535;
-	}
-
-	for (i = 0; i < word_len; ++i) {
-		uint16_t word;
-		memcpy(&word, data, sizeof(word));
-		data += 2;
-		c0 = c0 + word;
-		c1 = c1 + c0;
-	}
-
-	if (len & 1) {
-		c0 = c0 + data[0];
-		c1 = c1 + c0;
-	}
-
-	c0 = c0 % 65535;
-	c1 = c1 % 65535;
-
-	return (c1 << 16 | c0);
-}
+uint64_t sdtp_default_clock(void* ctx) {
+	(void)ctx;
+
+	struct timespec ts;
+#if defined(CLOCK_MONOTONIC)
+	// Unaffected by NTP steps and settimeofday()
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) return 0;
+#else
+	if (timespec_get(&ts, TIME_UTC) != TIME_UTC) return 0;
+#endif
 
-bool sdtp_verify_fletcher32(const uint8_t *data, const size_t length, const uint32_t checksum) {
-	return sdtp_calculate_fletcher32(data, length) == checksum;
+	return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
 }
@@ -2,61 +2,170 @@
 
 #include <api/libsdtp.h>
 
-#include <stdlib.h>
 #include <string.h>
 
 sdtp_packet_t* sdtp_construct_packet(const char* data, const sdtp_packet_type_t packet_type, const uint32_t packet_id)
 {
 	if (!data) return NULL;
 
-	size_t body_size = 0;
-	uint8_t* body = sdtp_char_to_bytes(data, &body_size);
-	if (!body) return NULL;
+	return sdtp_construct_packet_bytes((const uint8_t*)data, strlen(data), packet_type, packet_id);
+}
 
-	// Prevent int overflow
-	if (body_size > UINT32_MAX) return NULL;
-	const uint32_t body_size32 = (uint32_t)body_size;
+sdtp_packet_t* sdtp_construct_packet_bytes(const uint8_t* data, const size_t data_len, const sdtp_packet_type_t packet_type, const uint32_t packet_id)
+{
+	return sdtp_construct_packet_with(NULL, data, data_len, packet_type, packet_id);
+}
 
-	// Allocate packet struct
-	sdtp_packet_t* packet = (sdtp_packet_t*)malloc(sizeof(sdtp_packet_t));
-	if (!packet) {
-		free(body);
+sdtp_packet_t* sdtp_construct_packet_with(const sdtp_allocator_t* allocator, const uint8_t* data, const size_t data_len,
+                                          const sdtp_packet_type_t packet_type, const uint32_t packet_id)
+{
+	if (!data && data_len > 0) return NULL;
+
+	// Allocate packet with the body in the same block
+	sdtp_packet_t* packet = sdtp_packet_alloc(allocator, data_len);
+	if (!packet) return NULL;
+
+	// Copies data and fills header
+	if (!sdtp_construct_packet_into(packet, packet->body, data_len, data, data_len, packet_type, packet_id)) {
+		sdtp_packet_free(packet);
 		return NULL;
 	}
 
+	// Construct into resets allocator and body placement
+	packet->allocator = allocator;
+	packet->body_inline = data_len > 0;
+
+	return packet;
+}
+
+sdtp_packet_t* sdtp_construct_packet_iov(const sdtp_iovec_t* iov, const size_t iov_count,
+                                         const sdtp_packet_type_t packet_type, const uint32_t packet_id)
+{
+	const size_t data_len = sdtp_iov_length(iov, iov_count);
+	if (data_len == SIZE_MAX) return NULL;
+
+	// Allocate packet with the body in the same block
+	sdtp_packet_t* packet = sdtp_packet_alloc(NULL, data_len);
+	if (!packet) return NULL;
+
+	// Gather fragments into the body and checksum them on the way
+	sdtp_fletcher32_state_t state;
+	sdtp_fletcher32_init(&state);
+
+	size_t done = 0;
+	for (size_t i = 0; i < iov_count; ++i) {
+		if (iov[i].len == 0) continue;
+
+		memcpy(packet->body + done, iov[i].base, iov[i].len);
+		sdtp_fletcher32_update(&state, packet->body + done, iov[i].len);
+		done += iov[i].len;
+	}
+
 	// Header fields
-	packet->header.id        = packet_id;                                  // Random ID
-	packet->header.data_size = body_size32;                                // Copy data len
-	packet->header.type      = (uint32_t)packet_type;                      // Copy packet type
-	packet->header.checksum  = sdtp_calculate_fletcher32(body, body_size); // Fletcher-32 checksum
-
-	if (body_size > 0) {
-		// Allocate body
-		packet->body = (uint8_t*)malloc(body_size);
-		// If allocation failed
-		if (!packet->body) {
-			free(packet);
-			free(body);
-			return NULL;
-		}
+	packet->header.id        = packet_id;                      // Random ID
+	packet->header.data_size = (uint32_t)data_len;             // Copy data len
+	packet->header.type      = (uint32_t)packet_type;          // Copy packet type
+	packet->header.checksum  = sdtp_fletcher32_final(&state);  // Fletcher-32 checksum
 
-		// Copy data into a packet body
-		memcpy(packet->body, body, body_size);
-	} else {
-		packet->body = NULL;
+	return packet;
+}
+
+size_t sdtp_iov_length(const sdtp_iovec_t* iov, const size_t iov_count)
+{
+	if (!iov && iov_count > 0) return SIZE_MAX;
+
+	size_t total = 0;
+	for (size_t i = 0; i < iov_count; ++i) {
+		if (!iov[i].base && iov[i].len > 0) return SIZE_MAX;
+
+		// Body size is limited by the header field
+		if (iov[i].len > UINT32_MAX - total) return SIZE_MAX;
+		total += iov[i].len;
 	}
 
-	free(body);
+	return total;
+}
+
+sdtp_packet_t* sdtp_packet_alloc(const sdtp_allocator_t* allocator, const size_t data_size)
+{
+	// Prevent int overflow
+	if (data_size > UINT32_MAX || data_size > SIZE_MAX - sizeof(sdtp_packet_t)) return NULL;
+
+	// Packet struct and body in a single block
+	sdtp_packet_t* packet = (sdtp_packet_t*)sdtp_allocator_alloc(allocator, sizeof(sdtp_packet_t) + data_size);
+	if (!packet) return NULL;
+
+	memset(&packet->header, 0, sizeof(packet->header));
+	packet->header.data_size = (uint32_t)data_size;
+	packet->body = data_size > 0 ? (uint8_t*)(packet + 1) : NULL;
+	packet->allocator = allocator;
+	packet->body_inline = data_size > 0;
+
+	return packet;
+}
+
+sdtp_packet_t* sdtp_construct_packet_owned(uint8_t* data, const size_t data_len, const sdtp_packet_type_t packet_type, const uint32_t packet_id)
+{
+	if (!data && data_len > 0) return NULL;
+
+	// Prevent int overflow
+	if (data_len > UINT32_MAX) return NULL;
+
+	// Allocate packet struct
+	sdtp_packet_t* packet = sdtp_packet_alloc(NULL, 0);
+	if (!packet) return NULL;
+
+	// Header fields
+	packet->header.id        = packet_id;                                 // Random ID
+	packet->header.data_size = (uint32_t)data_len;                        // Copy data len
+	packet->header.type      = (uint32_t)packet_type;                     // Copy packet type
+	packet->header.checksum  = sdtp_calculate_fletcher32(data, data_len); // Fletcher-32 checksum
+
+	// Take body without copying
+	packet->body = data_len > 0 ? data : NULL;
+
 	return packet;
 }
 
+bool sdtp_construct_packet_into(sdtp_packet_t* packet, uint8_t* body_buffer, const size_t body_capacity,
+                                const uint8_t* data, const size_t data_len, const sdtp_packet_type_t packet_type, const uint32_t packet_id)
+{
+	if (!packet) return false;
+	if (data_len > 0 && (!data || !body_buffer)) return false;
+
+	// Prevent int and buffer overflow
+	if (data_len > UINT32_MAX || data_len > body_capacity) return false;
+
+	// Header fields
+	packet->header.id        = packet_id;              // Random ID
+	packet->header.data_size = (uint32_t)data_len;     // Copy data len
+	packet->header.type      = (uint32_t)packet_type;  // Copy packet type
+
+	// Copy data into a packet body and calculate Fletcher-32 checksum
+	packet->header.checksum = sdtp_copy_fletcher32(body_buffer, data, data_len);
+	packet->body = data_len > 0 ? body_buffer : NULL;
+	packet->allocator = NULL;
+	packet->body_inline = false;
+
+	return true;
+}
+
 void sdtp_packet_free(sdtp_packet_t* packet)
 {
 	if (!packet) return;
 
-	if (packet->body) { free(packet->body); packet->body = NULL; }
+	const sdtp_allocator_t* allocator = packet->allocator;
+	size_t packet_size = sizeof(sdtp_packet_t);
+
+	// Body is either in the same block or was allocated separately
+	if (packet->body_inline) {
+		packet_size += packet->header.data_size;
+	} else if (packet->body) {
+		sdtp_allocator_free(allocator, packet->body, packet->header.data_size);
+	}
+	packet->body = NULL;
 
-	free(packet);
+	sdtp_allocator_free(allocator, packet, packet_size);
 	packet = NULL;
 }
 
@@ -76,7 +185,7 @@ uint8_t* sdtp_serialize_packet(const sdtp_packet_t* packet, size_t* out_size) {
 	// SoH + header + data + EoT
     const size_t packet_size = 1 + header_bytes + (size_t)data_size + 1;
 
-    uint8_t* buffer = (uint8_t*)malloc(packet_size);
+    uint8_t* buffer = (uint8_t*)sdtp_allocator_alloc(NULL, packet_size);
     if (!buffer) return NULL;
 
     uint8_t* write_ptr = buffer;
@@ -84,7 +193,7 @@ uint8_t* sdtp_serialize_packet(const sdtp_packet_t* packet, size_t* out_size) {
 
 	// Write the SoH control character
 	const uint8_t start_of_heading = SDTP_START_OF_HEADER;
-	if (remaining < 1) { free(buffer); return NULL; }
+	if (remaining < 1) { sdtp_allocator_free(NULL, buffer, packet_size); return NULL; }
 	memcpy(write_ptr, &start_of_heading, 1);
 	write_ptr += 1;
 	remaining -= 1;
@@ -101,7 +210,7 @@ uint8_t* sdtp_serialize_packet(const sdtp_packet_t* packet, size_t* out_size) {
 	for (size_t i = 0; i < 4; ++i) {
 		uint32_t element = header_words[i];
 		// Prevent buffer overflow
-		if (remaining < sizeof(element)) { free(buffer); return NULL; }
+		if (remaining < sizeof(element)) { sdtp_allocator_free(NULL, buffer, packet_size); return NULL; }
 		// Copy element
 		memcpy(write_ptr, &element, sizeof(element));
 
@@ -113,7 +222,7 @@ uint8_t* sdtp_serialize_packet(const sdtp_packet_t* packet, size_t* out_size) {
 
     // Copy body data
     if (dsize > 0) {
-    	if (remaining < dsize) { free(buffer); return NULL; }
+    	if (remaining < dsize) { sdtp_allocator_free(NULL, buffer, packet_size); return NULL; }
         memcpy(write_ptr, packet->body, dsize);
         write_ptr += dsize;
         remaining -= dsize;
@@ -121,13 +230,13 @@ uint8_t* sdtp_serialize_packet(const sdtp_packet_t* packet, size_t* out_size) {
 
 	// Write the EoT control character
 	const uint8_t terminator = SDTP_TERMINATOR;
-	if (remaining < 1) { free(buffer); return NULL; }
+	if (remaining < 1) { sdtp_allocator_free(NULL, buffer, packet_size); return NULL; }
 	memcpy(write_ptr, &terminator, 1);
 	remaining -= 1;
 
     // Check if all data was written
     if (remaining != 0) {
-        free(buffer);
+        sdtp_allocator_free(NULL, buffer, packet_size);
         return NULL;
     }
 
@@ -135,9 +244,303 @@ uint8_t* sdtp_serialize_packet(const sdtp_packet_t* packet, size_t* out_size) {
     return buffer;
 }
 
-sdtp_packet_t* sdtp_deserialize_packet(const uint8_t* buffer, const size_t buf_size) {
-    if (!buffer) return NULL;
+size_t sdtp_serialize_packet_into(const sdtp_packet_t* packet, sdtp_buffer_t* buffer) {
+	// Validate input pointers
+	if (!packet || !buffer) return 0;
+
+	// Validate body pointer when data_size > 0
+	const uint32_t data_size = packet->header.data_size;
+	if (data_size > 0 && packet->body == NULL) return 0;
+
+	// Body is a single fragment
+	const sdtp_iovec_t body = { packet->body, data_size };
+
+	return sdtp_serialize_iov_into(&body, data_size > 0 ? 1 : 0, (sdtp_packet_type_t)packet->header.type,
+	                               packet->header.id, buffer);
+}
+
+size_t sdtp_serialize_iov_into(const sdtp_iovec_t* iov, const size_t iov_count, const sdtp_packet_type_t packet_type,
+                               const uint32_t packet_id, sdtp_buffer_t* buffer) {
+	return sdtp_serialize_iov_format_into(iov, iov_count, packet_type, packet_id, NULL, buffer);
+}
+
+size_t sdtp_serialize_iov_format_into(const sdtp_iovec_t* iov, const size_t iov_count, const sdtp_packet_type_t packet_type,
+                                      const uint32_t packet_id, const sdtp_header_format_t* format, sdtp_buffer_t* buffer) {
+	if (!buffer) return 0;
+
+	const size_t data_size = sdtp_iov_length(iov, iov_count);
+	if (data_size == SIZE_MAX) return 0;
+
+	// Header size depends on the layout the frame fits
+	uint8_t head[SDTP_HEAD_MAX_SIZE];
+	sdtp_fletcher32_state_t state;
+	const size_t head_size = sdtp_header_begin(head, format, (uint32_t)packet_type, packet_id, data_size, &state);
+
+	// Reserve space for the whole frame
+	const size_t packet_size = head_size + data_size + 1;
+	if (packet_size > sdtp_buffer_get_free_space(buffer)) return 0;
+
+	// Copy body fragments behind the header and checksum each chunk while it's in cache
+	size_t done = 0;
+	for (size_t i = 0; i < iov_count; ++i) {
+		size_t fragment_done = 0;
+		while (fragment_done < iov[i].len) {
+			size_t chunk = iov[i].len - fragment_done;
+			if (chunk > SDTP_FLETCHER32_CHUNK) chunk = SDTP_FLETCHER32_CHUNK;
+
+			sdtp_buffer_stage(buffer, head_size + done, iov[i].base + fragment_done, chunk);
+			sdtp_fletcher32_update(&state, iov[i].base + fragment_done, chunk);
+			fragment_done += chunk;
+			done += chunk;
+		}
+	}
+
+	// Header goes in front of the body once the checksum is known
+	sdtp_header_finish(head, head_size, &state);
+	sdtp_buffer_stage(buffer, 0, head, head_size);
+
+	// Write the EoT control character
+	const uint8_t terminator = SDTP_TERMINATOR;
+	sdtp_buffer_stage(buffer, packet_size - 1, &terminator, 1);
+
+	// Publish the whole frame at once
+	return sdtp_buffer_commit(buffer, packet_size);
+}
+
+// Size of a compact size code
+static size_t sdtp_header_code_size(const uint32_t code) {
+	static const size_t sizes[4] = { 0, 1, 2, 4 };
+
+	return sizes[code & 3u];
+}
+
+// Compact size code of a size (4 - no such code)
+static uint32_t sdtp_header_size_code(const size_t size) {
+	switch (size) {
+		case 0: return 0;
+		case 1: return 1;
+		case 2: return 2;
+		case 4: return 3;
+		default: return 4;
+	}
+}
+
+// Whether the frame can go with the compact header without losing anything
+static bool sdtp_header_compact_fits(const sdtp_header_format_t* format, const uint32_t packet_type,
+                                     const uint32_t packet_id) {
+	if (!format) return false;
+
+	// Only flags with a format bit, base type in one byte
+	if ((packet_type & SDTP_TYPE_FLAGS) & ~(SDTP_TYPE_FRAGMENT | SDTP_TYPE_RELIABLE | SDTP_TYPE_COMPRESSED)) return false;
+	if (SDTP_TYPE_BASE(packet_type) > UINT8_MAX) return false;
 
+	return format->id_size == 4 || packet_id >> (8 * format->id_size) == 0;
+}
+
+size_t sdtp_header_begin(uint8_t* head, const sdtp_header_format_t* format, const uint32_t packet_type,
+                         const uint32_t packet_id, const size_t data_size, sdtp_fletcher32_state_t* state) {
+	sdtp_fletcher32_init(state);
+
+	if (!sdtp_header_compact_fits(format, packet_type, packet_id)) {
+		const uint32_t header_words[4] = { packet_id, (uint32_t)data_size, packet_type, 0 };
+
+		head[0] = SDTP_START_OF_HEADER;
+		memcpy(head + 1, header_words, SDTP_HEADER_SIZE);
+
+		return SDTP_HEAD_MAX_SIZE;
+	}
+
+	size_t pos = 0;
+	head[pos++] = SDTP_START_OF_COMPACT;
+	head[pos++] = (uint8_t)(sdtp_header_size_code(format->id_size) << 6 |
+	                        sdtp_header_size_code(format->checksum_size) << 4 |
+	                        (packet_type & SDTP_TYPE_FLAGS) >> 28);
+
+	uint32_t length = (uint32_t)data_size;
+	while (length >= 0x80) {
+		head[pos++] = (uint8_t)(length | 0x80);
+		length >>= 7;
+	}
+	head[pos++] = (uint8_t)length;
+
+	head[pos++] = (uint8_t)packet_type;
+	for (size_t i = 0; i < format->id_size; ++i) {
+		head[pos++] = (uint8_t)(packet_id >> (8 * i));
+	}
+
+	// Unlike the full header, the compact one is covered by the checksum
+	sdtp_fletcher32_update(state, head + 1, pos - 1);
+
+	return pos + format->checksum_size;
+}
+
+void sdtp_header_finish(uint8_t* head, const size_t head_size, const sdtp_fletcher32_state_t* state) {
+	const uint32_t checksum = sdtp_fletcher32_final(state);
+
+	if (head[0] == SDTP_START_OF_HEADER) {
+		memcpy(head + 1 + 3 * sizeof(uint32_t), &checksum, sizeof(checksum));
+		return;
+	}
+
+	const size_t checksum_size = sdtp_header_code_size(head[1] >> 4);
+	const uint32_t folded = sdtp_checksum_fold(checksum, checksum_size);
+	for (size_t i = 0; i < checksum_size; ++i) {
+		head[head_size - checksum_size + i] = (uint8_t)(folded >> (8 * i));
+	}
+}
+
+size_t sdtp_header_decode(const uint8_t* data, const size_t len, sdtp_packet_header_t* header, size_t* checksum_size) {
+	if (!data || !header || !checksum_size) return SIZE_MAX;
+	if (len == 0) return 0;
+
+	if (data[0] == SDTP_START_OF_HEADER) {
+		if (len < SDTP_HEAD_MAX_SIZE) return 0;
+
+		uint32_t header_words[4];
+		memcpy(header_words, data + 1, SDTP_HEADER_SIZE);
+
+		header->id        = header_words[0];
+		header->data_size = header_words[1];
+		header->type      = header_words[2];
+		header->checksum  = header_words[3];
+		*checksum_size = sizeof(uint32_t);
+
+		return SDTP_HEAD_MAX_SIZE;
+	}
+
+	if (data[0] != SDTP_START_OF_COMPACT) return SIZE_MAX;
+	if (len < 2) return 0;
+
+	// Reserved bit and checksum code must be valid
+	const uint8_t format = data[1];
+	const size_t id_size = sdtp_header_code_size((uint32_t)format >> 6);
+	const size_t sum_size = sdtp_header_code_size((uint32_t)format >> 4);
+	if ((format & 0x01) != 0 || sum_size == 0) return SIZE_MAX;
+
+	size_t pos = 2;
+	uint32_t length = 0;
+	for (size_t shift = 0;; shift += 7) {
+		if (pos == len) return 0;
+
+		const uint8_t byte = data[pos++];
+
+		// Fifth byte carries the top 4 bits only
+		if (shift == 28 && byte > 0x0F) return SIZE_MAX;
+		length |= (uint32_t)(byte & 0x7F) << shift;
+
+		if (!(byte & 0x80)) break;
+	}
+
+	const size_t head_size = pos + 1 + id_size + sum_size;
+	if (len < head_size) return 0;
+
+	header->type = (uint32_t)data[pos++] | ((uint32_t)(format & 0x0E) << 28);
+
+	header->id = 0;
+	for (size_t i = 0; i < id_size; ++i) {
+		header->id |= (uint32_t)data[pos++] << (8 * i);
+	}
+
+	header->checksum = 0;
+	for (size_t i = 0; i < sum_size; ++i) {
+		header->checksum |= (uint32_t)data[pos++] << (8 * i);
+	}
+
+	header->data_size = length;
+	*checksum_size = sum_size;
+
+	return head_size;
+}
+
+void sdtp_header_checksum(const uint8_t* head, const size_t head_size, const size_t checksum_size,
+                          sdtp_fletcher32_state_t* state) {
+	if (head[0] != SDTP_START_OF_COMPACT) return;
+
+	sdtp_fletcher32_update(state, head + 1, head_size - 1 - checksum_size);
+}
+
+uint32_t sdtp_checksum_fold(const uint32_t checksum, const size_t checksum_size) {
+	if (checksum_size >= 4) return checksum;
+
+	// Sums reduced mod 255 still catch every single-bit error, XOR folding wouldn't
+	const uint32_t c0 = (checksum & 0xFFFFu) % 255;
+	const uint32_t c1 = (checksum >> 16) % 255;
+
+	return checksum_size == 2 ? (c1 << 8 | c0) : c0;
+}
+
+const uint8_t* sdtp_find_frame_start(const uint8_t* data, const size_t len) {
+	if (!data) return NULL;
+
+	// Two memchr passes beat a byte loop, the second one stops at the first hit
+	const uint8_t* full = (const uint8_t*)memchr(data, SDTP_START_OF_HEADER, len);
+	const size_t limit = full ? (size_t)(full - data) : len;
+	const uint8_t* compact = (const uint8_t*)memchr(data, SDTP_START_OF_COMPACT, limit);
+
+	return compact ? compact : full;
+}
+
+uint8_t* sdtp_serialize_packet_compact(const sdtp_packet_t* packet, const sdtp_header_format_t* format,
+                                       size_t* out_size) {
+	// Validate input pointers
+	if (!packet || !out_size) return NULL;
+	if (packet->header.data_size > 0 && packet->body == NULL) return NULL;
+
+	const size_t data_size = packet->header.data_size;
+
+	uint8_t head[SDTP_HEAD_MAX_SIZE];
+	sdtp_fletcher32_state_t state;
+	const size_t head_size = sdtp_header_begin(head, format, packet->header.type, packet->header.id, data_size, &state);
+
+	// Header + data + EoT
+	const size_t packet_size = head_size + data_size + 1;
+	if (data_size > SIZE_MAX - head_size - 1) return NULL;
+
+	uint8_t* buffer = (uint8_t*)sdtp_allocator_alloc(NULL, packet_size);
+	if (!buffer) return NULL;
+
+	// Checksum covers the header, so it's computed again
+	if (data_size > 0) {
+		memcpy(buffer + head_size, packet->body, data_size);
+		sdtp_fletcher32_update(&state, packet->body, data_size);
+	}
+	sdtp_header_finish(head, head_size, &state);
+	memcpy(buffer, head, head_size);
+	buffer[packet_size - 1] = SDTP_TERMINATOR;
+
+	*out_size = packet_size;
+	return buffer;
+}
+
+// Deserializes frame with the compact header
+static sdtp_packet_t* sdtp_deserialize_compact(const uint8_t* buffer, const size_t buf_size) {
+	sdtp_packet_header_t header;
+	size_t checksum_size = 0;
+	const size_t head_size = sdtp_header_decode(buffer, buf_size, &header, &checksum_size);
+	if (head_size == 0 || head_size == SIZE_MAX) return NULL;
+
+	// Header + body + terminator
+	if (buf_size - head_size < 1 || (size_t)header.data_size > buf_size - head_size - 1) return NULL;
+	const size_t packet_size = head_size + header.data_size + 1;
+	if (buffer[packet_size - 1] != SDTP_TERMINATOR) return NULL;
+
+	sdtp_fletcher32_state_t state;
+	sdtp_fletcher32_init(&state);
+	sdtp_header_checksum(buffer, head_size, checksum_size, &state);
+	sdtp_fletcher32_update(&state, buffer + head_size, header.data_size);
+	if (sdtp_checksum_fold(sdtp_fletcher32_final(&state), checksum_size) != header.checksum) return NULL;
+
+	sdtp_packet_t* packet = sdtp_packet_alloc(NULL, header.data_size);
+	if (!packet) return NULL;
+
+	packet->header = header;
+	if (header.data_size > 0) memcpy(packet->body, buffer + head_size, header.data_size);
+
+	return packet;
+}
+
+// Deserializes frame with the full header
+static sdtp_packet_t* sdtp_deserialize_full(const uint8_t* buffer, const size_t buf_size) {
     const size_t header_bytes = 4 * sizeof(uint32_t);
 
     // Need at least SoH, header and terminator
@@ -180,7 +583,7 @@ sdtp_packet_t* sdtp_deserialize_packet(const uint8_t* buffer, const size_t buf_s
     if (remaining < (size_t)data_size + 1) return NULL; // body + terminator
 
     // Allocate packet struct for writing
-    sdtp_packet_t* packet = (sdtp_packet_t*)malloc(sizeof(sdtp_packet_t));
+    sdtp_packet_t* packet = sdtp_packet_alloc(NULL, data_size);
     if (!packet) return NULL;
 
 	// Copy header
@@ -191,35 +594,39 @@ sdtp_packet_t* sdtp_deserialize_packet(const uint8_t* buffer, const size_t buf_s
 
 	// Copy body
     if (data_size > 0) {
-        packet->body = (uint8_t*)malloc(data_size);
-        if (!packet->body) {
-            free(packet);
-            return NULL;
-        }
-
         memcpy(packet->body, read_ptr, data_size);
 
         read_ptr += data_size;
         remaining -= data_size;
-    } else {
-        packet->body = NULL;
     }
 
 	// Verify checksum
 	if (!sdtp_verify_fletcher32(packet->body, data_size, checksum)) {
-		if (packet->body) free(packet->body);
-		free(packet);
+		sdtp_packet_free(packet);
 
 		return NULL;
 	}
 
     // Check terminator
     if (remaining < 1 || *read_ptr != SDTP_TERMINATOR) {
-        if (packet->body) free(packet->body);
-
-        free(packet);
+        sdtp_packet_free(packet);
         return NULL;
     }
 
     return packet;
 }
+
+sdtp_packet_t* sdtp_deserialize_packet(const uint8_t* buffer, const size_t buf_size) {
+	if (!buffer || buf_size == 0) return NULL;
+
+	sdtp_packet_t* packet = buffer[0] == SDTP_START_OF_COMPACT ? sdtp_deserialize_compact(buffer, buf_size)
+	                                                           : sdtp_deserialize_full(buffer, buf_size);
+	if (!packet || !(packet->header.type & SDTP_TYPE_COMPRESSED)) return packet;
+
+	// Hand out the original payload
+	const sdtp_packet_view_t view = { packet->header, packet->body, 0 };
+	sdtp_packet_t* plain = sdtp_decompress_packet(NULL, &view, 0);
+	sdtp_packet_free(packet);
+
+	return plain;
+}
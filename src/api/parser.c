@@ -0,0 +1,215 @@
+// Copyright (c) 2026 bazelik
+
+#include <api/libsdtp.h>
+
+#include <string.h>
+
+// Forgets the current frame, keeps bytes held by views
+static void sdtp_parser_restart(sdtp_parser_t* parser) {
+	parser->state = SDTP_PARSER_SEEK;
+	memset(&parser->header, 0, sizeof(parser->header));
+	parser->head_size = 0;
+	parser->checksum_size = 0;
+
+	sdtp_fletcher32_init(&parser->checksum);
+	parser->checked = 0;
+}
+
+void sdtp_parser_skip(sdtp_parser_t* parser, sdtp_buffer_t* buffer, const size_t len) {
+	if (!parser || !buffer) return;
+
+	// Bytes behind unreleased views are only marked,
+	// they're dropped from the buffer together with the next view
+	if (parser->views == 0) {
+		sdtp_buffer_consume(buffer, len);
+		return;
+	}
+
+	parser->offset += len;
+	parser->lead += len;
+}
+
+void sdtp_parser_reset(sdtp_parser_t* parser) {
+	if (!parser) return;
+
+	sdtp_parser_restart(parser);
+	parser->offset = 0;
+	parser->lead = 0;
+	parser->views = 0;
+	parser->dropped = 0;
+}
+
+// Frame size of the current header
+static size_t sdtp_parser_frame_size(const sdtp_parser_t* parser) {
+	return parser->head_size + (size_t)parser->header.data_size + 1;
+}
+
+// Skips bytes before the next start byte. Returns true if a start byte is at the parser position.
+static bool sdtp_parser_seek(sdtp_parser_t* parser, sdtp_buffer_t* buffer) {
+	size_t span_len = 0;
+	const uint8_t* span;
+
+	while ((span = sdtp_buffer_get_read_span(buffer, parser->offset, &span_len)) != NULL) {
+		const uint8_t* soh = sdtp_find_frame_start(span, span_len);
+
+		// Every examined byte before SoH is garbage
+		sdtp_parser_skip(parser, buffer, soh ? (size_t)(soh - span) : span_len);
+		if (soh) return true;
+	}
+
+	return false;
+}
+
+bool sdtp_parser_next(sdtp_parser_t* parser, sdtp_buffer_t* buffer, sdtp_packet_header_t* header) {
+	if (!parser || !buffer || !header) return false;
+
+	for (;;) {
+		const size_t used_space = sdtp_buffer_get_used_space(buffer);
+
+		// Buffer may have been cleared or overwritten since the last call
+		if (parser->offset > used_space) {
+			sdtp_parser_reset(parser);
+		}
+
+		// Frames were dropped from under the current one
+		if (parser->dropped != buffer->dropped) {
+			parser->dropped = buffer->dropped;
+			sdtp_parser_restart(parser);
+		}
+		const size_t available = used_space - parser->offset;
+
+		if (parser->state != SDTP_PARSER_SEEK) {
+			uint8_t first = 0;
+			if (sdtp_buffer_peek(buffer, parser->offset, &first, 1) != 1 ||
+			    (first != SDTP_START_OF_HEADER && first != SDTP_START_OF_COMPACT)) {
+				sdtp_parser_restart(parser);
+			}
+		}
+
+		switch (parser->state) {
+			case SDTP_PARSER_SEEK:
+				if (!sdtp_parser_seek(parser, buffer)) return false;
+				parser->state = SDTP_PARSER_HEADER;
+				break;
+
+			case SDTP_PARSER_HEADER: {
+				// Layout is told by the start byte, compact headers vary in size
+				uint8_t head[SDTP_HEAD_MAX_SIZE];
+				const size_t head_len = available < sizeof(head) ? available : sizeof(head);
+				sdtp_buffer_peek(buffer, parser->offset, head, head_len);
+
+				// Compact start byte is garbage until the header was negotiated
+				if (head[0] == SDTP_START_OF_COMPACT && !parser->compact) {
+					sdtp_parser_reject(parser, buffer);
+					break;
+				}
+
+				const size_t head_size = sdtp_header_decode(head, head_len, &parser->header, &parser->checksum_size);
+				if (head_size == 0) return false;
+
+				// Frame that can never fit the buffer means the start byte was garbage
+				if (head_size == SIZE_MAX ||
+				    (size_t)parser->header.data_size > sdtp_buffer_get_max_frame(buffer) - head_size - 1) {
+					sdtp_parser_reject(parser, buffer);
+					break;
+				}
+				parser->head_size = head_size;
+				sdtp_header_checksum(head, head_size, parser->checksum_size, &parser->checksum);
+
+				parser->state = SDTP_PARSER_BODY;
+				break;
+			}
+
+			case SDTP_PARSER_BODY: {
+				const size_t data_size = parser->header.data_size;
+				const size_t body_offset = parser->offset + parser->head_size;
+
+				// Checksum body bytes received since the last call
+				size_t span_len = 0;
+				const uint8_t* span;
+				while (parser->checked < data_size &&
+				       (span = sdtp_buffer_get_read_span(buffer, body_offset + parser->checked, &span_len)) != NULL) {
+					if (span_len > data_size - parser->checked) span_len = data_size - parser->checked;
+
+					sdtp_fletcher32_update(&parser->checksum, span, span_len);
+					parser->checked += span_len;
+				}
+
+				const size_t frame_size = sdtp_parser_frame_size(parser);
+				if (available < frame_size) return false;
+
+				// Check terminator and checksum
+				uint8_t terminator = 0;
+				sdtp_buffer_peek(buffer, parser->offset + frame_size - 1, &terminator, 1);
+				const uint32_t checksum = sdtp_checksum_fold(sdtp_fletcher32_final(&parser->checksum), parser->checksum_size);
+				if (terminator != SDTP_TERMINATOR || checksum != parser->header.checksum) {
+					sdtp_parser_reject(parser, buffer);
+					break;
+				}
+
+				parser->state = SDTP_PARSER_READY;
+				break;
+			}
+
+			case SDTP_PARSER_READY:
+				*header = parser->header;
+				return true;
+
+			default:
+				sdtp_parser_restart(parser);
+				break;
+		}
+	}
+}
+
+void sdtp_parser_release(sdtp_parser_t* parser, sdtp_buffer_t* buffer) {
+	if (!parser || !buffer) return;
+
+	if (parser->state == SDTP_PARSER_READY) {
+		sdtp_parser_skip(parser, buffer, sdtp_parser_frame_size(parser));
+	}
+
+	sdtp_parser_restart(parser);
+}
+
+void sdtp_parser_reject(sdtp_parser_t* parser, sdtp_buffer_t* buffer) {
+	if (!parser || !buffer) return;
+
+	// Drop only the start byte, the rest may contain a real frame
+	if (parser->state != SDTP_PARSER_SEEK) {
+		sdtp_parser_skip(parser, buffer, 1);
+	}
+
+	sdtp_parser_restart(parser);
+}
+
+size_t sdtp_parser_hold(sdtp_parser_t* parser) {
+	if (!parser || parser->state != SDTP_PARSER_READY) return 0;
+
+	// View owns the frame and everything skipped since the previous view
+	const size_t frame_size = sdtp_parser_frame_size(parser);
+	const size_t span = parser->lead + frame_size;
+
+	parser->offset += frame_size;
+	parser->lead = 0;
+	parser->views++;
+
+	sdtp_parser_restart(parser);
+	return span;
+}
+
+void sdtp_parser_unhold(sdtp_parser_t* parser, sdtp_buffer_t* buffer, size_t span) {
+	if (!parser || !buffer || parser->views == 0) return;
+
+	if (span > parser->offset) span = parser->offset;
+	sdtp_buffer_consume(buffer, span);
+	parser->offset -= span;
+	parser->views--;
+
+	// Without views, skipped bytes are plain garbage
+	if (parser->views == 0) {
+		sdtp_buffer_consume(buffer, parser->offset);
+		parser->offset = 0;
+		parser->lead = 0;
+	}
+}
@@ -0,0 +1,162 @@
+// Copyright (c) 2026 bazelik
+
+#include <api/libsdtp.h>
+
+#include <string.h>
+
+#define SDTP_POOL_ALIGN _Alignof(max_align_t)
+
+// Rounds block size up to the alignment (0 on overflow)
+static size_t sdtp_pool_round_block(const size_t size) {
+	if (size > SIZE_MAX - (SDTP_POOL_ALIGN - 1)) return 0;
+
+	size_t block = (size + SDTP_POOL_ALIGN - 1) & ~(SDTP_POOL_ALIGN - 1);
+
+	// Free block stores a pointer to the next one
+	if (block < sizeof(void*)) block = SDTP_POOL_ALIGN;
+
+	return block;
+}
+
+size_t sdtp_pool_storage_size(const size_t* block_sizes, const size_t* block_counts, const size_t class_count) {
+	if (!block_sizes || !block_counts) return 0;
+	if (class_count == 0 || class_count > SDTP_POOL_MAX_CLASSES) return 0;
+
+	size_t total = 0;
+	for (size_t i = 0; i < class_count; ++i) {
+		const size_t block = sdtp_pool_round_block(block_sizes[i]);
+		if (block == 0 || block_sizes[i] == 0) return 0;
+
+		// Prevent overflow
+		if (block_counts[i] > (SIZE_MAX - total) / block) return 0;
+		total += block * block_counts[i];
+	}
+
+	return total;
+}
+
+// Finds the class which owns the block
+static sdtp_pool_class_t* sdtp_pool_find_class(sdtp_pool_t* pool, const uint8_t* ptr) {
+	for (size_t i = 0; i < pool->class_count; ++i) {
+		sdtp_pool_class_t* pool_class = &pool->classes[i];
+		if (ptr >= pool_class->start && ptr < pool_class->end) return pool_class;
+	}
+
+	return NULL;
+}
+
+static void* sdtp_pool_alloc(void* ctx, const size_t size) {
+	sdtp_pool_t* pool = (sdtp_pool_t*)ctx;
+
+	// Smallest class with a free block that fits
+	for (size_t i = 0; i < pool->class_count; ++i) {
+		sdtp_pool_class_t* pool_class = &pool->classes[i];
+		if (pool_class->block_size < size || !pool_class->free_list) continue;
+
+		// Pop block
+		void* block = pool_class->free_list;
+		memcpy(&pool_class->free_list, block, sizeof(void*));
+		pool_class->free_count--;
+
+		return block;
+	}
+
+	// Pool exhausted or block is too big
+	if (!pool->fallback) return NULL;
+	return sdtp_allocator_alloc(pool->fallback, size);
+}
+
+static void sdtp_pool_free(void* ctx, void* ptr, const size_t size) {
+	sdtp_pool_t* pool = (sdtp_pool_t*)ctx;
+
+	sdtp_pool_class_t* pool_class = sdtp_pool_find_class(pool, (const uint8_t*)ptr);
+	if (!pool_class) {
+		// Block came from the fallback allocator
+		if (pool->fallback) sdtp_allocator_free(pool->fallback, ptr, size);
+		return;
+	}
+
+	// Push block
+	memcpy(ptr, &pool_class->free_list, sizeof(void*));
+	pool_class->free_list = ptr;
+	pool_class->free_count++;
+}
+
+bool sdtp_pool_init(sdtp_pool_t* pool, const size_t* block_sizes, const size_t* block_counts, const size_t class_count,
+                    void* storage, size_t storage_size, const sdtp_allocator_t* fallback) {
+	if (!pool) return false;
+
+	const size_t required = sdtp_pool_storage_size(block_sizes, block_counts, class_count);
+	if (required == 0) return false;
+
+	memset(pool, 0, sizeof(*pool));
+
+	// Get storage
+	if (storage) {
+		if (storage_size < required) return false;
+		if ((uintptr_t)storage % SDTP_POOL_ALIGN != 0) return false;
+	} else {
+		storage = sdtp_allocator_alloc(NULL, required);
+		if (!storage) return false;
+		storage_size = required;
+		pool->owns_storage = true;
+	}
+
+	pool->storage = (uint8_t*)storage;
+	pool->storage_size = storage_size;
+	pool->fallback = fallback;
+
+	// Sort classes by block size (insertion sort, at most SDTP_POOL_MAX_CLASSES)
+	for (size_t i = 0; i < class_count; ++i) {
+		sdtp_pool_class_t pool_class = { 0 };
+		pool_class.block_size = sdtp_pool_round_block(block_sizes[i]);
+		pool_class.block_count = block_counts[i];
+
+		size_t j = i;
+		while (j > 0 && pool->classes[j - 1].block_size > pool_class.block_size) {
+			pool->classes[j] = pool->classes[j - 1];
+			j--;
+		}
+		pool->classes[j] = pool_class;
+	}
+	pool->class_count = class_count;
+
+	// Carve storage into blocks and chain them
+	uint8_t* cursor = pool->storage;
+	for (size_t i = 0; i < class_count; ++i) {
+		sdtp_pool_class_t* pool_class = &pool->classes[i];
+
+		pool_class->start = cursor;
+		for (size_t k = pool_class->block_count; k > 0; --k) {
+			uint8_t* block = cursor + (k - 1) * pool_class->block_size;
+
+			memcpy(block, &pool_class->free_list, sizeof(void*));
+			pool_class->free_list = block;
+		}
+		pool_class->free_count = pool_class->block_count;
+
+		cursor += pool_class->block_count * pool_class->block_size;
+		pool_class->end = cursor;
+	}
+
+	// Allocator interface
+	pool->allocator.alloc = sdtp_pool_alloc;
+	pool->allocator.free = sdtp_pool_free;
+	pool->allocator.ctx = pool;
+
+	return true;
+}
+
+void sdtp_pool_destroy(sdtp_pool_t* pool) {
+	if (!pool) return;
+
+	if (pool->owns_storage) sdtp_allocator_free(NULL, pool->storage, pool->storage_size);
+
+	memset(pool, 0, sizeof(*pool));
+}
+
+const sdtp_allocator_t* sdtp_pool_allocator(sdtp_pool_t* pool) {
+	if (!pool || pool->class_count == 0) return NULL;
+
+	return &pool->allocator;
+}
@@ -0,0 +1,188 @@
+// Copyright (c) 2026 bazelik
+
+#include <api/libsdtp.h>
+
+// Size of the frame at the queue head (0 - empty)
+static size_t sdtp_priority_head_frame(const sdtp_buffer_t* queue) {
+	// Queues hold only whole frames written by the instance
+	uint8_t head[SDTP_HEAD_MAX_SIZE];
+	const size_t head_len = sdtp_buffer_peek(queue, 0, head, sizeof(head));
+
+	sdtp_packet_header_t header;
+	size_t checksum_size = 0;
+	const size_t head_size = sdtp_header_decode(head, head_len, &header, &checksum_size);
+	if (head_size == 0 || head_size == SIZE_MAX) return 0;
+
+	return head_size + header.data_size + 1;
+}
+
+// Bytes waiting in all class queues
+static size_t sdtp_priority_waiting(const sdtp_scheduler_t* scheduler) {
+	size_t waiting = 0;
+	for (size_t i = 0; i < SDTP_PRIORITY_CLASSES; ++i) {
+		waiting += sdtp_buffer_get_used_space(&scheduler->queues[i]);
+	}
+
+	return waiting;
+}
+
+// Moves the head frame to the output buffer
+static void sdtp_priority_move(sdtp_buffer_t* queue, sdtp_buffer_t* output, const size_t frame_size) {
+	// At most two spans because of wrap-around
+	size_t moved = 0;
+	while (moved < frame_size) {
+		size_t span_len = 0;
+		const uint8_t* span = sdtp_buffer_get_read_span(queue, moved, &span_len);
+		if (!span) break;
+
+		if (span_len > frame_size - moved) span_len = frame_size - moved;
+		sdtp_buffer_stage(output, moved, span, span_len);
+		moved += span_len;
+	}
+
+	sdtp_buffer_commit(output, frame_size);
+	sdtp_buffer_consume(queue, frame_size);
+}
+
+// Highest class with frames goes first
+static size_t sdtp_priority_schedule_strict(sdtp_scheduler_t* scheduler, sdtp_buffer_t* output) {
+	size_t moved = 0;
+
+	for (;;) {
+		size_t class_index = 0;
+		size_t frame_size = 0;
+		while (class_index < SDTP_PRIORITY_CLASSES &&
+		       (frame_size = sdtp_priority_head_frame(&scheduler->queues[class_index])) == 0) {
+			class_index++;
+		}
+
+		// Lower classes never overtake a frame which doesn't fit yet
+		if (frame_size == 0 || frame_size > sdtp_buffer_get_free_space(output)) break;
+
+		sdtp_priority_move(&scheduler->queues[class_index], output, frame_size);
+		moved += frame_size;
+	}
+
+	return moved;
+}
+
+// Deficit round robin, position is kept between calls
+static size_t sdtp_priority_schedule_weighted(sdtp_scheduler_t* scheduler, sdtp_buffer_t* output) {
+	size_t moved = 0;
+
+	while (sdtp_priority_waiting(scheduler) > 0) {
+		const size_t current = scheduler->current;
+		sdtp_buffer_t* queue = &scheduler->queues[current];
+
+		// Each visit adds the class weight once
+		if (!scheduler->charged) {
+			scheduler->deficits[current] += scheduler->weights[current];
+			scheduler->charged = true;
+		}
+
+		size_t frame_size;
+		while ((frame_size = sdtp_priority_head_frame(queue)) > 0 && frame_size <= scheduler->deficits[current]) {
+			// Resume with this class once there's room
+			if (frame_size > sdtp_buffer_get_free_space(output)) return moved;
+
+			sdtp_priority_move(queue, output, frame_size);
+			scheduler->deficits[current] -= frame_size;
+			moved += frame_size;
+		}
+
+		// Idle classes don't save up
+		if (frame_size == 0) scheduler->deficits[current] = 0;
+
+		scheduler->current = (current + 1) % SDTP_PRIORITY_CLASSES;
+		scheduler->charged = false;
+	}
+
+	return moved;
+}
+
+bool sdtp_instance_set_priorities(sdtp_instance_t* instance, const sdtp_priority_config_t* config, uint8_t* storage) {
+	if (!instance) return false;
+
+	sdtp_scheduler_t* scheduler = &instance->scheduler;
+
+	// Validate before anything is touched
+	size_t queue_size = 0;
+	if (config) {
+		queue_size = config->queue_size ? config->queue_size : instance->config.buffer_size;
+		if (queue_size == 0 || (queue_size & (queue_size - 1)) != 0) return false;
+		if (queue_size > SIZE_MAX / SDTP_PRIORITY_CLASSES) return false;
+
+		if (config->schedule == SDTP_SCHEDULE_WEIGHTED) {
+			for (size_t i = 0; i < SDTP_PRIORITY_CLASSES; ++i) {
+				if (config->weights[i] == 0) return false;
+			}
+		}
+	}
+
+	// Don't lose frames waiting in the old queues (disabling drops what can't be written)
+	if ((!sdtp_flush(instance) || sdtp_priority_pending(instance) > 0) && config) return false;
+
+	if (scheduler->owns_storage) {
+		sdtp_allocator_free(instance->config.allocator, scheduler->storage, scheduler->queues[0].size * SDTP_PRIORITY_CLASSES);
+	}
+	scheduler->enabled = false;
+	scheduler->storage = NULL;
+	scheduler->owns_storage = false;
+
+	if (!config) return true;
+
+	if (!storage) {
+		storage = (uint8_t*)sdtp_allocator_alloc(instance->config.allocator, SDTP_PRIORITY_STORAGE_SIZE(queue_size));
+		if (!storage) return false;
+		scheduler->owns_storage = true;
+	}
+	scheduler->storage = storage;
+
+	for (size_t i = 0; i < SDTP_PRIORITY_CLASSES; ++i) {
+		sdtp_buffer_init(&scheduler->queues[i], storage + i * queue_size, queue_size);
+		scheduler->weights[i] = config->weights[i];
+		scheduler->deficits[i] = 0;
+	}
+	scheduler->schedule = config->schedule;
+	scheduler->current = 0;
+	scheduler->charged = false;
+	scheduler->enabled = true;
+
+	return true;
+}
+
+bool sdtp_set_type_priority(sdtp_instance_t* instance, const sdtp_packet_type_t packet_type, const sdtp_priority_t priority) {
+	if (!instance) return false;
+	if ((uint32_t)packet_type >= SDTP_DISPATCH_TYPE_COUNT) return false;
+	if ((uint32_t)priority >= SDTP_PRIORITY_CLASSES) return false;
+
+	instance->scheduler.type_priority[packet_type] = priority;
+
+	return true;
+}
+
+sdtp_priority_t sdtp_get_type_priority(const sdtp_instance_t* instance, const uint32_t packet_type) {
+	// Flags don't change the class
+	const uint32_t base_type = SDTP_TYPE_BASE(packet_type);
+	if (!instance || base_type >= SDTP_DISPATCH_TYPE_COUNT) return SDTP_PRIORITY_NORMAL;
+
+	return instance->scheduler.type_priority[base_type];
+}
+
+size_t sdtp_priority_pending(const sdtp_instance_t* instance) {
+	if (!instance || !instance->scheduler.enabled) return 0;
+
+	return sdtp_priority_waiting(&instance->scheduler);
+}
+
+size_t sdtp_priority_schedule(sdtp_instance_t* instance) {
+	if (!instance || !instance->scheduler.enabled) return 0;
+
+	sdtp_buffer_t* output = sdtp_buffer_get_by_type(instance, SDTP_OUTPUT_BUFFER);
+	if (!output) return 0;
+
+	if (instance->scheduler.schedule == SDTP_SCHEDULE_WEIGHTED) {
+		return sdtp_priority_schedule_weighted(&instance->scheduler, output);
+	}
+	return sdtp_priority_schedule_strict(&instance->scheduler, output);
+}
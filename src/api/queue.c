@@ -0,0 +1,236 @@
+// Copyright (c) 2026 bazelik
+
+#include <api/libsdtp.h>
+
+#include <string.h>
+
+#define SDTP_QUEUE_MIN_SIZE SDTP_QUEUE_RECORD_SIZE(SDTP_FRAME_SIZE(0))
+
+// Sets up queue fields over zeroed memory
+static void sdtp_queue_setup(sdtp_queue_t* queue, uint8_t* data, const size_t capacity) {
+	queue->size = capacity;
+	queue->mask = capacity - 1;
+
+	atomic_init(&queue->head, 0);
+	atomic_init(&queue->tail, 0);
+
+	queue->data = data;
+	queue->words = (sdtp_atomic_uint32_t*)(void*)data;
+}
+
+// Record header word at the queue position
+static sdtp_atomic_uint32_t* sdtp_queue_word(const sdtp_queue_t* queue, const size_t position) {
+	return &queue->words[(position & queue->mask) / sizeof(uint32_t)];
+}
+
+sdtp_queue_t* sdtp_queue_create(const size_t size, const sdtp_allocator_t* allocator) {
+	if (size < SDTP_QUEUE_MIN_SIZE) return NULL;
+
+	// Round capacity up to a power of two
+	size_t capacity = 1;
+	while (capacity < size) {
+		if (capacity > SIZE_MAX / 2) return NULL;
+		capacity <<= 1;
+	}
+
+	// Allocate queue struct
+	sdtp_queue_t* queue = (sdtp_queue_t*)sdtp_allocator_alloc(allocator, sizeof(sdtp_queue_t));
+	if (!queue) return NULL;
+
+	// Allocate data, record headers must start zeroed
+	uint8_t* data = (uint8_t*)sdtp_allocator_alloc(allocator, capacity);
+	if (!data) {
+		sdtp_allocator_free(allocator, queue, sizeof(sdtp_queue_t));
+		return NULL;
+	}
+	memset(data, 0, capacity);
+
+	sdtp_queue_setup(queue, data, capacity);
+	queue->allocator = allocator;
+	queue->owns_memory = true;
+
+	return queue;
+}
+
+bool sdtp_queue_init(sdtp_queue_t* queue, void* storage, const size_t storage_size) {
+	if (!queue || !storage || storage_size < SDTP_QUEUE_MIN_SIZE) return false;
+	if ((uintptr_t)storage % sizeof(uint32_t) != 0) return false;
+
+	// Largest power of two which fits storage
+	size_t capacity = 1;
+	while (capacity <= storage_size / 2) capacity <<= 1;
+
+	// Record headers must start zeroed
+	memset(storage, 0, capacity);
+
+	sdtp_queue_setup(queue, (uint8_t*)storage, capacity);
+	queue->allocator = NULL;
+	queue->owns_memory = false;
+
+	return true;
+}
+
+void sdtp_queue_free(sdtp_queue_t* queue) {
+	if (!queue) return;
+
+	// Caller memory
+	if (!queue->owns_memory) {
+		queue->data = NULL;
+		queue->words = NULL;
+		return;
+	}
+
+	const sdtp_allocator_t* allocator = queue->allocator;
+
+	sdtp_allocator_free(allocator, queue->data, queue->size);
+	queue->data = NULL;
+	queue->words = NULL;
+
+	sdtp_allocator_free(allocator, queue, sizeof(sdtp_queue_t));
+}
+
+void sdtp_instance_set_queue(sdtp_instance_t* instance, sdtp_queue_t* queue) {
+	if (!instance) return;
+
+	instance->output_queue = queue;
+}
+
+bool sdtp_enqueue_packet(sdtp_instance_t* instance, const sdtp_packet_t* packet) {
+	if (!instance || !packet || !instance->output_queue) return false;
+	if (packet->header.data_size > 0 && !packet->body) return false;
+
+	sdtp_queue_t* queue = instance->output_queue;
+
+	// Frame must fit both the queue and the output buffer
+	const size_t frame_size = SDTP_FRAME_SIZE(packet->header.data_size);
+	if (frame_size > instance->config.buffer_size) return false;
+
+	const size_t record_size = SDTP_QUEUE_RECORD_SIZE(frame_size);
+	if (record_size > queue->size || record_size > UINT32_MAX) return false;
+
+	// Reserve record: only the producer which moves tail owns the space
+	size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+	do {
+		const size_t head = atomic_load_explicit(&queue->head, memory_order_acquire);
+		if (record_size > queue->size - (tail - head)) return false;
+	} while (!atomic_compare_exchange_weak_explicit(&queue->tail, &tail, tail + record_size,
+	                                                memory_order_relaxed, memory_order_relaxed));
+
+	// Serialize through a buffer window which has exactly the frame space free
+	const size_t frame_position = tail + SDTP_QUEUE_RECORD_HEADER_SIZE;
+	sdtp_buffer_t window = { 0 };
+	window.size = queue->size;
+	window.mask = queue->mask;
+	window.data = queue->data;
+	atomic_init(&window.head, frame_position + frame_size - queue->size);
+	atomic_init(&window.tail, frame_position);
+
+	sdtp_serialize_packet_into(packet, &window);
+
+	// Commit: flusher sees the frame bytes once it sees the record size
+	atomic_store_explicit(sdtp_queue_word(queue, tail + sizeof(uint32_t)), (uint32_t)frame_size, memory_order_relaxed);
+	atomic_store_explicit(sdtp_queue_word(queue, tail), (uint32_t)record_size, memory_order_release);
+
+	return true;
+}
+
+// Copies frame bytes at the queue position, they may wrap around the queue end
+static void sdtp_queue_copy(const sdtp_queue_t* queue, const size_t position, uint8_t* destination, const size_t len) {
+	const size_t start = position & queue->mask;
+	const size_t first = len < queue->size - start ? len : queue->size - start;
+
+	memcpy(destination, queue->data + start, first);
+	if (first < len) memcpy(destination + first, queue->data, len - first);
+}
+
+// Moves the frame to the output buffer as it is
+static bool sdtp_queue_move_frame(sdtp_instance_t* instance, const sdtp_queue_t* queue, const size_t position,
+                                  const size_t frame_size) {
+	sdtp_buffer_t* buffer = instance->output_buffer;
+
+	// Write the batch once the output buffer is full
+	if (frame_size > sdtp_buffer_get_free_space(buffer)) {
+		sdtp_io_write(instance);
+		if (frame_size > sdtp_buffer_get_free_space(buffer)) return false;
+	}
+
+	// Start flush deadline when the frame is the oldest pending output
+	if (instance->coalesce.enabled && sdtp_buffer_get_used_space(buffer) == 0) {
+		instance->pending_since = sdtp_instance_now(instance);
+	}
+
+	// Copy the frame, it may wrap around the queue end
+	const size_t start = position & queue->mask;
+	const size_t first = frame_size < queue->size - start ? frame_size : queue->size - start;
+	sdtp_buffer_stage(buffer, 0, queue->data + start, first);
+	if (first < frame_size) {
+		sdtp_buffer_stage(buffer, first, queue->data, frame_size - first);
+	}
+	sdtp_buffer_commit(buffer, frame_size);
+
+	return true;
+}
+
+// Sends the frame payload through the output path of sdtp_write_packet()
+static bool sdtp_queue_output_frame(sdtp_instance_t* instance, const sdtp_queue_t* queue, const size_t position) {
+	uint8_t head[1 + SDTP_HEADER_SIZE];
+	sdtp_queue_copy(queue, position, head, sizeof(head));
+
+	uint32_t header_words[4];
+	memcpy(header_words, head + 1, SDTP_HEADER_SIZE);
+	const uint32_t packet_id = header_words[0];
+	const size_t data_size = header_words[1];
+	const uint32_t packet_type = header_words[2];
+
+	// Body may wrap around the queue end
+	const size_t start = (position + sizeof(head)) & queue->mask;
+	const size_t first = data_size < queue->size - start ? data_size : queue->size - start;
+	const sdtp_iovec_t body[2] = {
+		{ queue->data + start, first },
+		{ queue->data, data_size - first }
+	};
+	const size_t count = data_size == 0 ? 0 : (first < data_size ? 2 : 1);
+
+	return sdtp_output_packet_iov(instance, body, count, (sdtp_packet_type_t)packet_type, packet_id,
+	                              sdtp_get_type_priority(instance, packet_type)) > 0;
+}
+
+size_t sdtp_flush_queue(sdtp_instance_t* instance) {
+	if (!instance || !instance->output_queue) return 0;
+
+	sdtp_queue_t* queue = instance->output_queue;
+
+	// Producers serialize with the full header, frames are re-encoded only if output isn't plain
+	const bool plain = sdtp_output_is_plain(instance);
+
+	size_t flushed = 0;
+	size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+	for (;;) {
+		// Records are taken in order, an uncommitted one stops the batch
+		const uint32_t record_size = atomic_load_explicit(sdtp_queue_word(queue, head), memory_order_acquire);
+		if (record_size == 0) break;
+
+		const size_t frame_size = atomic_load_explicit(sdtp_queue_word(queue, head + sizeof(uint32_t)), memory_order_relaxed);
+		const size_t frame_position = head + SDTP_QUEUE_RECORD_HEADER_SIZE;
+
+		// Frame stays queued if there's no room for it
+		const bool moved = plain ? sdtp_queue_move_frame(instance, queue, frame_position, frame_size)
+		                         : sdtp_queue_output_frame(instance, queue, frame_position);
+		if (!moved) break;
+
+		// Zero the record, the next lap may start a record header anywhere in it
+		for (size_t offset = 0; offset < record_size; offset += sizeof(uint32_t)) {
+			atomic_store_explicit(sdtp_queue_word(queue, head + offset), 0, memory_order_relaxed);
+		}
+
+		// Release the space to producers
+		head += record_size;
+		atomic_store_explicit(&queue->head, head, memory_order_release);
+		flushed++;
+	}
+
+	// Single write call for the whole batch (only when due if coalescing)
+	sdtp_flush_due(instance);
+
+	return flushed;
+}
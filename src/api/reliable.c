@@ -0,0 +1,379 @@
+// Copyright (c) 2026 bazelik
+
+#include <api/libsdtp.h>
+
+#include <string.h>
+
+// Slot of a sequence
+static sdtp_reliable_slot_t* sdtp_reliable_slot(sdtp_reliable_t* reliable, const uint32_t seq) {
+	return &reliable->slots[seq % SDTP_RELIABLE_MAX_WINDOW];
+}
+
+// Sends body of a frame in flight from the retransmit store
+static bool sdtp_reliable_transmit(sdtp_instance_t* instance, const uint32_t seq) {
+	sdtp_reliable_t* reliable = &instance->reliable;
+
+	// Bodies are stored back to back from the oldest sequence
+	size_t offset = 0;
+	for (uint32_t i = reliable->send_base; i != seq; ++i) {
+		offset += sdtp_reliable_slot(reliable, i)->body_size;
+	}
+
+	const sdtp_reliable_slot_t* slot = sdtp_reliable_slot(reliable, seq);
+
+	// At most two spans because of wrap-around
+	sdtp_iovec_t spans[2];
+	size_t count = 0;
+	size_t taken = 0;
+	while (taken < slot->body_size && count < 2) {
+		size_t span_len = 0;
+		const uint8_t* span = sdtp_buffer_get_read_span(&reliable->store, offset + taken, &span_len);
+		if (!span) return false;
+
+		if (span_len > slot->body_size - taken) span_len = slot->body_size - taken;
+		spans[count++] = (sdtp_iovec_t){ span, span_len };
+		taken += span_len;
+	}
+
+	return sdtp_write_packet_iov(instance, spans, count, (sdtp_packet_type_t)slot->type, slot->id);
+}
+
+// Forgets frames in flight, the store keeps its memory
+static void sdtp_reliable_drop(sdtp_reliable_t* reliable) {
+	sdtp_buffer_consume(&reliable->store, sdtp_buffer_get_used_space(&reliable->store));
+	memset(reliable->slots, 0, sizeof(reliable->slots));
+	reliable->send_base = reliable->send_next;
+}
+
+// Frees frames held for delivery
+static void sdtp_reliable_release_held(sdtp_reliable_t* reliable) {
+	for (size_t i = 0; i < SDTP_RELIABLE_MAX_WINDOW; ++i) {
+		sdtp_packet_free(reliable->held[i]);
+		reliable->held[i] = NULL;
+	}
+}
+
+// Updates round trip estimate (Jacobson/Karels)
+static void sdtp_reliable_sample(sdtp_reliable_t* reliable, const uint64_t rtt_us) {
+	if (!reliable->has_rtt) {
+		reliable->srtt_us = rtt_us;
+		reliable->rttvar_us = rtt_us / 2;
+		reliable->has_rtt = true;
+	} else {
+		const uint64_t delta = reliable->srtt_us > rtt_us ? reliable->srtt_us - rtt_us : rtt_us - reliable->srtt_us;
+		reliable->rttvar_us = (3 * reliable->rttvar_us + delta) / 4;
+		reliable->srtt_us = (7 * reliable->srtt_us + rtt_us) / 8;
+	}
+
+	uint64_t rto = reliable->srtt_us + 4 * reliable->rttvar_us;
+	if (rto < reliable->config.min_rto_us) rto = reliable->config.min_rto_us;
+	if (rto > reliable->config.max_rto_us) rto = reliable->config.max_rto_us;
+	reliable->rto_us = rto;
+}
+
+// Releases frames acknowledged by the peer
+static void sdtp_reliable_on_ack(sdtp_instance_t* instance, const sdtp_packet_view_t* view) {
+	sdtp_reliable_t* reliable = &instance->reliable;
+	if (view->header.data_size != SDTP_ACK_SIZE) return;
+
+	uint32_t ack[2];
+	memcpy(ack, view->body, SDTP_ACK_SIZE);
+	const uint32_t cumulative = ack[0];
+	const uint32_t selective = ack[1];
+
+	// Acks from before a reset or for frames never sent are stale
+	const uint32_t in_flight = reliable->send_next - reliable->send_base;
+	if (cumulative - reliable->send_base > in_flight) return;
+
+	const uint64_t now = sdtp_instance_now(instance);
+
+	for (uint32_t seq = reliable->send_base; seq != reliable->send_next; ++seq) {
+		sdtp_reliable_slot_t* slot = sdtp_reliable_slot(reliable, seq);
+		if (slot->acked) continue;
+
+		const uint32_t distance = seq - cumulative;
+		const bool acked = distance > in_flight || (distance > 0 && (selective >> (distance - 1)) & 1u);
+		if (!acked) continue;
+
+		slot->acked = true;
+
+		// Retransmitted frames don't tell which copy was acknowledged (Karn)
+		if (slot->retransmits == 0) sdtp_reliable_sample(reliable, now - slot->sent_at);
+	}
+
+	// Window slides over the acknowledged prefix
+	while (reliable->send_base != reliable->send_next) {
+		sdtp_reliable_slot_t* slot = sdtp_reliable_slot(reliable, reliable->send_base);
+		if (!slot->acked) break;
+
+		sdtp_buffer_consume(&reliable->store, slot->body_size);
+		*slot = (sdtp_reliable_slot_t){ 0 };
+		reliable->send_base++;
+	}
+}
+
+bool sdtp_instance_set_reliable(sdtp_instance_t* instance, const sdtp_reliable_config_t* config, uint8_t* storage) {
+	if (!instance) return false;
+
+	sdtp_reliable_t* reliable = &instance->reliable;
+
+	// Validate before anything is touched
+	size_t storage_size = 0;
+	if (config) {
+		if (config->window == 0 || config->window > SDTP_RELIABLE_MAX_WINDOW) return false;
+		if (config->min_rto_us == 0 || config->min_rto_us > config->max_rto_us) return false;
+		if (config->initial_rto_us < config->min_rto_us || config->initial_rto_us > config->max_rto_us) return false;
+
+		storage_size = config->storage_size ? config->storage_size : 4 * instance->config.buffer_size;
+		if (storage_size == 0 || (storage_size & (storage_size - 1)) != 0) return false;
+	}
+
+	if (reliable->owns_storage) {
+		sdtp_allocator_free(instance->config.allocator, reliable->storage, reliable->store.size);
+	}
+	sdtp_reliable_release_held(reliable);
+	reliable->enabled = false;
+	reliable->storage = NULL;
+	reliable->owns_storage = false;
+
+	if (!config) return true;
+
+	if (!storage) {
+		storage = (uint8_t*)sdtp_allocator_alloc(instance->config.allocator, storage_size);
+		if (!storage) return false;
+		reliable->owns_storage = true;
+	}
+	reliable->storage = storage;
+	sdtp_buffer_init(&reliable->store, storage, storage_size);
+
+	reliable->config = *config;
+	reliable->config.storage_size = storage_size;
+	reliable->enabled = true;
+
+	sdtp_reliable_reset(instance);
+
+	return true;
+}
+
+void sdtp_reliable_reset(sdtp_instance_t* instance) {
+	if (!instance) return;
+
+	sdtp_reliable_t* reliable = &instance->reliable;
+
+	sdtp_reliable_drop(reliable);
+	reliable->send_base = 0;
+	reliable->send_next = 0;
+
+	reliable->recv_next = 0;
+	reliable->recv_bitmap = 0;
+	reliable->deliver_next = 0;
+	sdtp_reliable_release_held(reliable);
+	reliable->ack_pending = false;
+
+	// New peer, new path
+	reliable->srtt_us = 0;
+	reliable->rttvar_us = 0;
+	reliable->rto_us = reliable->config.initial_rto_us;
+	reliable->has_rtt = false;
+}
+
+bool sdtp_write_reliable(sdtp_instance_t* instance, const sdtp_packet_t* packet) {
+	if (!instance || !packet) return false;
+
+	const sdtp_iovec_t body = { packet->body, packet->header.data_size };
+
+	return sdtp_write_reliable_iov(instance, &body, body.len > 0 ? 1 : 0,
+	                               (sdtp_packet_type_t)packet->header.type, packet->header.id);
+}
+
+bool sdtp_write_reliable_iov(sdtp_instance_t* instance, const sdtp_iovec_t* iov, const size_t iov_count,
+                             const sdtp_packet_type_t packet_type, const uint32_t packet_id) {
+	if (!instance || !instance->reliable.enabled) return false;
+
+	sdtp_reliable_t* reliable = &instance->reliable;
+
+	const size_t data_size = sdtp_iov_length(iov, iov_count);
+	if (data_size == SIZE_MAX || data_size > UINT32_MAX - SDTP_RELIABLE_PREFIX_SIZE) return false;
+
+	// Window and store limit what is in flight
+	if (reliable->send_next - reliable->send_base >= reliable->config.window) return false;
+
+	const size_t body_size = SDTP_RELIABLE_PREFIX_SIZE + data_size;
+	if (body_size > sdtp_buffer_get_free_space(&reliable->store)) return false;
+
+	// Keep the body until the peer acknowledges it
+	const uint32_t seq = reliable->send_next;
+	size_t staged = sdtp_buffer_stage(&reliable->store, 0, (const uint8_t*)&seq, SDTP_RELIABLE_PREFIX_SIZE);
+	for (size_t i = 0; i < iov_count; ++i) {
+		staged += sdtp_buffer_stage(&reliable->store, staged, iov[i].base, iov[i].len);
+	}
+	sdtp_buffer_commit(&reliable->store, body_size);
+
+	*sdtp_reliable_slot(reliable, seq) = (sdtp_reliable_slot_t){
+		body_size,
+		(uint32_t)packet_type | SDTP_TYPE_RELIABLE,
+		packet_id,
+		sdtp_instance_now(instance),
+		0,
+		false
+	};
+	reliable->send_next++;
+
+	// Frame is in flight either way, a failed send is repaired by the retransmit timer
+	sdtp_reliable_transmit(instance, seq);
+
+	return true;
+}
+
+bool sdtp_reliable_receive(sdtp_instance_t* instance, const sdtp_packet_view_t* frame, sdtp_packet_view_t* inner) {
+	if (!instance || !frame || !inner) return false;
+
+	sdtp_reliable_t* reliable = &instance->reliable;
+	*inner = *frame;
+
+	if (!reliable->enabled) return true;
+
+	if (SDTP_TYPE_BASE(frame->header.type) == SDTP_ACK) {
+		sdtp_reliable_on_ack(instance, frame);
+		return false;
+	}
+
+	if (!(frame->header.type & SDTP_TYPE_RELIABLE)) return true;
+	if (frame->header.data_size < SDTP_RELIABLE_PREFIX_SIZE) return false;
+
+	uint32_t seq;
+	memcpy(&seq, frame->body, SDTP_RELIABLE_PREFIX_SIZE);
+
+	// Every reliable frame is acknowledged, even a duplicate: our ack may have been lost
+	reliable->ack_pending = true;
+
+	// Already received or beyond the peer window
+	const uint32_t distance = seq - reliable->recv_next;
+	if (distance > SDTP_RELIABLE_MAX_WINDOW) return false;
+	if (distance > 0 && (reliable->recv_bitmap >> (distance - 1)) & 1u) return false;
+
+	inner->header.type = frame->header.type & ~SDTP_TYPE_RELIABLE;
+	inner->header.data_size = frame->header.data_size - (uint32_t)SDTP_RELIABLE_PREFIX_SIZE;
+	inner->header.checksum = 0;
+	inner->body = frame->body + SDTP_RELIABLE_PREFIX_SIZE;
+
+	// Frames behind a missing one wait for it, the view won't outlive the call
+	const bool due = seq == reliable->deliver_next;
+	if (!due) {
+		if (seq - reliable->deliver_next >= SDTP_RELIABLE_MAX_WINDOW) return false;
+
+		// Without memory the frame isn't marked received, so the peer sends it again
+		sdtp_packet_t* packet = sdtp_packet_alloc(instance->config.allocator, inner->header.data_size);
+		if (!packet) return false;
+
+		packet->header = inner->header;
+		if (inner->header.data_size > 0) memcpy(packet->body, inner->body, inner->header.data_size);
+		reliable->held[seq % SDTP_RELIABLE_MAX_WINDOW] = packet;
+	}
+
+	if (distance == 0) {
+		// Slide over frames which arrived early
+		reliable->recv_next++;
+		while (reliable->recv_bitmap & 1u) {
+			reliable->recv_bitmap >>= 1;
+			reliable->recv_next++;
+		}
+		reliable->recv_bitmap >>= 1;
+	} else {
+		reliable->recv_bitmap |= 1u << (distance - 1);
+	}
+
+	if (!due) return false;
+
+	reliable->deliver_next++;
+
+	return true;
+}
+
+sdtp_packet_t* sdtp_reliable_take_held(sdtp_instance_t* instance) {
+	if (!instance || !instance->reliable.enabled) return NULL;
+
+	sdtp_reliable_t* reliable = &instance->reliable;
+
+	// Everything before recv_next was received, what wasn't delivered is held
+	if (reliable->deliver_next == reliable->recv_next) return NULL;
+
+	sdtp_packet_t** slot = &reliable->held[reliable->deliver_next % SDTP_RELIABLE_MAX_WINDOW];
+	sdtp_packet_t* packet = *slot;
+	*slot = NULL;
+	reliable->deliver_next++;
+
+	return packet;
+}
+
+size_t sdtp_reliable_poll(sdtp_instance_t* instance) {
+	if (!instance || !instance->reliable.enabled) return 0;
+
+	sdtp_reliable_t* reliable = &instance->reliable;
+
+	// One ack covers everything received since the last one
+	if (reliable->ack_pending) {
+		const uint32_t ack[2] = { reliable->recv_next, reliable->recv_bitmap };
+		const sdtp_iovec_t body = { (const uint8_t*)ack, SDTP_ACK_SIZE };
+
+		if (sdtp_write_packet_iov(instance, &body, 1, SDTP_ACK, 0)) reliable->ack_pending = false;
+	}
+
+	const uint64_t now = sdtp_instance_now(instance);
+
+	size_t retransmitted = 0;
+	for (uint32_t seq = reliable->send_base; seq != reliable->send_next; ++seq) {
+		sdtp_reliable_slot_t* slot = sdtp_reliable_slot(reliable, seq);
+		if (slot->acked || now - slot->sent_at < reliable->rto_us) continue;
+
+		// Peer is gone, frames in flight are lost with the link
+		if (reliable->config.max_retries != 0 && slot->retransmits >= reliable->config.max_retries) {
+			sdtp_reliable_drop(reliable);
+			reliable->failures++;
+			instance->link.state = SDTP_LINK_DOWN;
+			break;
+		}
+
+		slot->retransmits++;
+		slot->sent_at = now;
+		sdtp_reliable_transmit(instance, seq);
+		retransmitted++;
+	}
+
+	// Back off while the path keeps losing frames
+	if (retransmitted > 0) {
+		reliable->rto_us = reliable->rto_us > reliable->config.max_rto_us / 2 ? reliable->config.max_rto_us
+		                                                                        : reliable->rto_us * 2;
+		reliable->retransmits += retransmitted;
+	}
+
+	return retransmitted;
+}
+
+uint64_t sdtp_reliable_next_timeout(const sdtp_instance_t* instance) {
+	if (!instance || !instance->reliable.enabled) return UINT64_MAX;
+
+	const sdtp_reliable_t* reliable = &instance->reliable;
+	if (reliable->ack_pending) return 0;
+
+	const uint64_t now = sdtp_instance_now(instance);
+
+	// Earliest retransmit of the frames in flight
+	uint64_t timeout = UINT64_MAX;
+	for (uint32_t seq = reliable->send_base; seq != reliable->send_next; ++seq) {
+		const sdtp_reliable_slot_t* slot = &reliable->slots[seq % SDTP_RELIABLE_MAX_WINDOW];
+		if (slot->acked) continue;
+
+		const uint64_t age = now - slot->sent_at;
+		const uint64_t left = age < reliable->rto_us ? reliable->rto_us - age : 0;
+		if (left < timeout) timeout = left;
+	}
+
+	return timeout;
+}
+
+size_t sdtp_reliable_in_flight(const sdtp_instance_t* instance) {
+	if (!instance || !instance->reliable.enabled) return 0;
+
+	return instance->reliable.send_next - instance->reliable.send_base;
+}
@@ -0,0 +1,130 @@
+// Copyright (c) 2026 bazelik
+
+#define _GNU_SOURCE
+
+#include "hal_linux.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/uio.h>
+#include <termios.h>
+#include <unistd.h>
+
+// Reads whatever is available without blocking
+static size_t sdtp_hal_read_into(void* ctx, uint8_t* buffer, const size_t capacity) {
+	sdtp_hal_linux_t* driver = (sdtp_hal_linux_t*)ctx;
+	if (driver->read_fd < 0 || driver->eof) return 0;
+
+	for (;;) {
+		const ssize_t read_len = read(driver->read_fd, buffer, capacity);
+		if (read_len > 0) return (size_t)read_len;
+
+		// Raw terminal without timeouts returns 0 when there's no data
+		if (read_len == 0 && driver->terminal) return 0;
+
+		// Peer closed (pty master reports it as EIO)
+		if (read_len == 0 || errno == EIO) {
+			driver->eof = true;
+			return 0;
+		}
+
+		if (errno == EINTR) continue;
+		return 0;
+	}
+}
+
+// Writes segments until the descriptor is full, the caller keeps the rest buffered
+static size_t sdtp_hal_writev(void* ctx, const sdtp_iovec_t* iov, const size_t count) {
+	sdtp_hal_linux_t* driver = (sdtp_hal_linux_t*)ctx;
+	if (driver->write_fd < 0) return 0;
+
+	size_t total = 0;
+	size_t index = 0;
+	size_t offset = 0;
+	while (index < count) {
+		// Segments left to write, the first one may be partially written
+		struct iovec vec[SDTP_IOV_MAX];
+		int vec_count = 0;
+		for (size_t i = index; i < count && vec_count < SDTP_IOV_MAX; ++i) {
+			const size_t skip = i == index ? offset : 0;
+			vec[vec_count].iov_base = (void*)(uintptr_t)(iov[i].base + skip);
+			vec[vec_count].iov_len = iov[i].len - skip;
+			vec_count++;
+		}
+
+		ssize_t written = writev(driver->write_fd, vec, vec_count);
+		if (written < 0) {
+			if (errno == EINTR) continue;
+			return total;
+		}
+
+		// Advance past written bytes
+		total += (size_t)written;
+		while (index < count && (size_t)written >= iov[index].len - offset) {
+			written -= (ssize_t)(iov[index].len - offset);
+			offset = 0;
+			index++;
+		}
+		offset += (size_t)written;
+	}
+
+	return total;
+}
+
+void sdtp_hal_attach(sdtp_hal_linux_t* driver, const int read_fd, const int write_fd, const bool owns_write_fd) {
+	driver->read_fd = read_fd;
+	driver->write_fd = write_fd;
+	driver->owns_write_fd = owns_write_fd;
+	driver->terminal = read_fd >= 0 && isatty(read_fd);
+	driver->eof = false;
+
+	driver->hooks.ctx = driver;
+	driver->hooks.read_into = sdtp_hal_read_into;
+	driver->hooks.writev = sdtp_hal_writev;
+}
+
+bool sdtp_hal_set_nonblocking(const int fd) {
+	const int flags = fcntl(fd, F_GETFL);
+	if (flags < 0) return false;
+
+	return fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+bool sdtp_hal_set_raw(const int fd, const unsigned int speed) {
+	struct termios tty;
+	if (tcgetattr(fd, &tty) != 0) return false;
+
+	// No echo, no line editing, no translation of control bytes
+	cfmakeraw(&tty);
+	tty.c_cflag |= CLOCAL | CREAD;
+	tty.c_cc[VMIN] = 0;
+	tty.c_cc[VTIME] = 0;
+
+	if (speed != 0) {
+		if (cfsetispeed(&tty, (speed_t)speed) != 0 || cfsetospeed(&tty, (speed_t)speed) != 0) return false;
+	}
+
+	if (tcsetattr(fd, TCSANOW, &tty) != 0) return false;
+	tcflush(fd, TCIOFLUSH);
+
+	return true;
+}
+
+void sdtp_hal_close(sdtp_hal_linux_t* driver) {
+	if (!driver) return;
+
+	if (driver->owns_write_fd && driver->write_fd >= 0 && driver->write_fd != driver->read_fd) {
+		close(driver->write_fd);
+	}
+	if (driver->read_fd >= 0) close(driver->read_fd);
+
+	driver->read_fd = -1;
+	driver->write_fd = -1;
+}
+
+const sdtp_function_hooks_v2* sdtp_hal_hooks(const sdtp_hal_linux_t* driver) {
+	if (!driver) return NULL;
+
+	return &driver->hooks;
+}
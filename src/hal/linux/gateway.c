@@ -0,0 +1,274 @@
+// Copyright (c) 2026 bazelik
+
+#define _GNU_SOURCE
+
+#include "hal_linux.h"
+
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Falls back to libc when a worker pool runs dry
+static const sdtp_allocator_t sdtp_gateway_heap = { NULL, NULL, NULL };
+
+static bool sdtp_handoff_init(sdtp_handoff_t* queue, const size_t size) {
+	size_t capacity = 1;
+	while (capacity < size) {
+		if (capacity > SIZE_MAX / 2 / sizeof(sdtp_gateway_item_t)) return false;
+		capacity <<= 1;
+	}
+
+	queue->slots = (sdtp_gateway_item_t*)malloc(capacity * sizeof(sdtp_gateway_item_t));
+	if (!queue->slots) return false;
+
+	queue->mask = capacity - 1;
+	atomic_init(&queue->head, 0);
+	atomic_init(&queue->tail, 0);
+
+	return true;
+}
+
+// Producer side
+static bool sdtp_handoff_push(sdtp_handoff_t* queue, const sdtp_gateway_item_t item) {
+	const size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+	const size_t head = atomic_load_explicit(&queue->head, memory_order_acquire);
+	if (tail - head > queue->mask) return false;
+
+	queue->slots[tail & queue->mask] = item;
+	atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+
+	return true;
+}
+
+// Consumer side
+static bool sdtp_handoff_pop(sdtp_handoff_t* queue, sdtp_gateway_item_t* item) {
+	const size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+	const size_t tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+	if (head == tail) return false;
+
+	*item = queue->slots[head & queue->mask];
+	atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+
+	return true;
+}
+
+// Relaxed counter increment, only the worker writes it
+static void sdtp_gateway_count(sdtp_atomic_size_t* counter, const size_t value) {
+	atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + value, memory_order_relaxed);
+}
+
+// Copies a verified frame out of the link buffer into the worker pool and hands it off
+static void sdtp_gateway_on_packet(sdtp_instance_t* instance, const sdtp_packet_view_t* view, void* ctx) {
+	(void)instance;
+
+	// Link ctx is the link itself, which knows its worker
+	sdtp_reactor_link_t* link = (sdtp_reactor_link_t*)ctx;
+	sdtp_gateway_worker_t* worker = link->worker;
+
+	sdtp_packet_t* packet = sdtp_packet_alloc(worker->allocator, view->header.data_size);
+	if (!packet) {
+		sdtp_gateway_count(&worker->dropped, 1);
+		return;
+	}
+
+	packet->header = view->header;
+	if (view->header.data_size > 0) memcpy(packet->body, view->body, view->header.data_size);
+
+	const sdtp_gateway_item_t item = { link, packet };
+	if (!sdtp_handoff_push(&worker->handoff, item)) {
+		sdtp_packet_free(packet);
+		sdtp_gateway_count(&worker->dropped, 1);
+		return;
+	}
+
+	sdtp_gateway_count(&worker->packets, 1);
+	sdtp_gateway_count(&worker->bytes, view->header.data_size);
+}
+
+// Frees packets returned by the application
+static void sdtp_gateway_drain_returns(sdtp_gateway_worker_t* worker) {
+	sdtp_gateway_item_t item;
+	while (sdtp_handoff_pop(&worker->returns, &item)) {
+		sdtp_packet_free(item.packet);
+	}
+}
+
+static void* sdtp_gateway_worker_main(void* arg) {
+	sdtp_gateway_worker_t* worker = (sdtp_gateway_worker_t*)arg;
+	sdtp_gateway_t* gateway = worker->gateway;
+
+	// Optional CPU pinning
+	if (gateway->config.pin_cpus) {
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+		CPU_SET((gateway->config.first_cpu + worker->index) % CPU_SETSIZE, &cpus);
+		pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+	}
+
+	while (atomic_load_explicit(&gateway->running, memory_order_acquire)) {
+		sdtp_gateway_drain_returns(worker);
+		sdtp_reactor_run_once(&worker->reactor, SDTP_GATEWAY_POLL_MS);
+	}
+
+	return NULL;
+}
+
+bool sdtp_gateway_init(sdtp_gateway_t* gateway, const sdtp_gateway_config_t* config) {
+	if (!gateway || !config || config->worker_count == 0 || config->handoff_size == 0) return false;
+
+	gateway->config = *config;
+	atomic_init(&gateway->running, 0);
+
+	gateway->workers = (sdtp_gateway_worker_t*)calloc(config->worker_count, sizeof(sdtp_gateway_worker_t));
+	if (!gateway->workers) return false;
+
+	for (size_t i = 0; i < config->worker_count; ++i) {
+		sdtp_gateway_worker_t* worker = &gateway->workers[i];
+		worker->gateway = gateway;
+		worker->index = i;
+		worker->reactor.epoll_fd = -1;
+
+		atomic_init(&worker->packets, 0);
+		atomic_init(&worker->bytes, 0);
+		atomic_init(&worker->dropped, 0);
+
+		bool status = sdtp_reactor_init(&worker->reactor) &&
+		              sdtp_handoff_init(&worker->handoff, config->handoff_size) &&
+		              sdtp_handoff_init(&worker->returns, config->handoff_size);
+
+		// Worker-private packet pool
+		if (status && config->pool_class_count > 0) {
+			status = sdtp_pool_init(&worker->pool, config->pool_block_sizes, config->pool_block_counts,
+			                        config->pool_class_count, NULL, 0, &sdtp_gateway_heap);
+			worker->allocator = sdtp_pool_allocator(&worker->pool);
+		}
+
+		if (!status) {
+			sdtp_gateway_destroy(gateway);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void sdtp_gateway_destroy(sdtp_gateway_t* gateway) {
+	if (!gateway || !gateway->workers) return;
+
+	sdtp_gateway_stop(gateway);
+
+	for (size_t i = 0; i < gateway->config.worker_count; ++i) {
+		sdtp_gateway_worker_t* worker = &gateway->workers[i];
+
+		// Packets never taken by the application go back to the pool
+		sdtp_gateway_item_t item;
+		if (worker->handoff.slots) {
+			while (sdtp_handoff_pop(&worker->handoff, &item)) sdtp_packet_free(item.packet);
+		}
+		if (worker->returns.slots) sdtp_gateway_drain_returns(worker);
+
+		free(worker->handoff.slots);
+		free(worker->returns.slots);
+		sdtp_pool_destroy(&worker->pool);
+		sdtp_reactor_close(&worker->reactor);
+	}
+
+	free(gateway->workers);
+	gateway->workers = NULL;
+}
+
+int sdtp_gateway_add(sdtp_gateway_t* gateway, sdtp_reactor_link_t* link) {
+	if (!gateway || !gateway->workers || !link) return -1;
+	if (atomic_load_explicit(&gateway->running, memory_order_relaxed)) return -1;
+
+	// Packets of the link go to the gateway, a callback of the caller would never run
+	if (link->on_packet || link->ctx) return -1;
+
+	// Least loaded worker
+	size_t index = 0;
+	for (size_t i = 1; i < gateway->config.worker_count; ++i) {
+		if (gateway->workers[i].reactor.link_count < gateway->workers[index].reactor.link_count) index = i;
+	}
+
+	link->on_packet = sdtp_gateway_on_packet;
+	link->ctx = link;
+	link->worker = &gateway->workers[index];
+	if (!sdtp_reactor_add(&gateway->workers[index].reactor, link)) {
+		link->on_packet = NULL;
+		link->ctx = NULL;
+		link->worker = NULL;
+		return -1;
+	}
+
+	return (int)index;
+}
+
+bool sdtp_gateway_start(sdtp_gateway_t* gateway) {
+	if (!gateway || !gateway->workers) return false;
+	if (atomic_load_explicit(&gateway->running, memory_order_relaxed)) return false;
+
+	atomic_store_explicit(&gateway->running, 1, memory_order_release);
+
+	for (size_t i = 0; i < gateway->config.worker_count; ++i) {
+		sdtp_gateway_worker_t* worker = &gateway->workers[i];
+
+		if (pthread_create(&worker->thread, NULL, sdtp_gateway_worker_main, worker) != 0) {
+			sdtp_gateway_stop(gateway);
+			return false;
+		}
+		worker->started = true;
+	}
+
+	return true;
+}
+
+void sdtp_gateway_stop(sdtp_gateway_t* gateway) {
+	if (!gateway || !gateway->workers) return;
+
+	// Workers notice within SDTP_GATEWAY_POLL_MS
+	atomic_store_explicit(&gateway->running, 0, memory_order_release);
+
+	for (size_t i = 0; i < gateway->config.worker_count; ++i) {
+		sdtp_gateway_worker_t* worker = &gateway->workers[i];
+		if (!worker->started) continue;
+
+		pthread_join(worker->thread, NULL);
+		worker->started = false;
+	}
+}
+
+size_t sdtp_gateway_poll(sdtp_gateway_t* gateway, const size_t worker, sdtp_gateway_item_t* items, const size_t max) {
+	if (!gateway || !gateway->workers || !items || worker >= gateway->config.worker_count) return 0;
+
+	size_t count = 0;
+	while (count < max && sdtp_handoff_pop(&gateway->workers[worker].handoff, &items[count])) count++;
+
+	return count;
+}
+
+void sdtp_gateway_release(sdtp_gateway_t* gateway, const size_t worker, sdtp_packet_t* packet) {
+	if (!gateway || !gateway->workers || !packet || worker >= gateway->config.worker_count) return;
+
+	// Pool belongs to the worker thread, so the packet is freed there
+	const sdtp_gateway_item_t item = { NULL, packet };
+	while (!sdtp_handoff_push(&gateway->workers[worker].returns, item)) {
+		// Stopped worker won't drain the queue anymore
+		if (!atomic_load_explicit(&gateway->running, memory_order_acquire)) {
+			sdtp_packet_free(packet);
+			return;
+		}
+		sched_yield();
+	}
+}
+
+bool sdtp_gateway_get_stats(const sdtp_gateway_t* gateway, const size_t worker, sdtp_gateway_stats_t* stats) {
+	if (!gateway || !gateway->workers || !stats || worker >= gateway->config.worker_count) return false;
+
+	const sdtp_gateway_worker_t* source = &gateway->workers[worker];
+	stats->links = source->reactor.link_count;
+	stats->packets = atomic_load_explicit(&source->packets, memory_order_relaxed);
+	stats->bytes = atomic_load_explicit(&source->bytes, memory_order_relaxed);
+	stats->dropped = atomic_load_explicit(&source->dropped, memory_order_relaxed);
+
+	return true;
+}
@@ -0,0 +1,29 @@
+// Copyright (c) 2026 bazelik
+
+#ifndef SDTP_HAL_LINUX_INTERNAL_H
+#define SDTP_HAL_LINUX_INTERNAL_H
+
+#include <hal/libsdtp_hal_linux.h>
+
+/**
+ * @brief Sets driver descriptors and hooks.
+ * @param driver Driver to initialize.
+ * @param read_fd Input descriptor (-1 - none).
+ * @param write_fd Output descriptor (-1 - none).
+ * @param owns_write_fd Whether write_fd is closed separately from read_fd.
+ **/
+void sdtp_hal_attach(sdtp_hal_linux_t* driver, int read_fd, int write_fd, bool owns_write_fd);
+/**
+ * @brief Switches descriptor to non-blocking mode.
+ * @return Status (false - error, true - success).
+ **/
+bool sdtp_hal_set_nonblocking(int fd);
+/**
+ * @brief Switches terminal to raw mode without timeouts.
+ * @param fd Terminal descriptor.
+ * @param speed Termios speed (0 - keep current).
+ * @return Status (false - error, true - success).
+ **/
+bool sdtp_hal_set_raw(int fd, unsigned int speed);
+
+#endif //SDTP_HAL_LINUX_INTERNAL_H
@@ -0,0 +1,54 @@
+// Copyright (c) 2026 bazelik
+
+#define _GNU_SOURCE
+
+#include "hal_linux.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+bool sdtp_hal_pty_open(sdtp_hal_linux_t* master, sdtp_hal_linux_t* slave) {
+	if (!master || !slave) return false;
+
+	const int master_fd = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+	if (master_fd < 0) return false;
+
+	// Slave side path
+	char path[128];
+	if (grantpt(master_fd) != 0 || unlockpt(master_fd) != 0 || ptsname_r(master_fd, path, sizeof(path)) != 0) {
+		close(master_fd);
+		return false;
+	}
+
+	const int slave_fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+	if (slave_fd < 0) {
+		close(master_fd);
+		return false;
+	}
+
+	// Line discipline lives on the slave side, it must pass bytes as is
+	if (!sdtp_hal_set_raw(slave_fd, 0) || !sdtp_hal_set_nonblocking(master_fd)) {
+		close(slave_fd);
+		close(master_fd);
+		return false;
+	}
+
+	sdtp_hal_attach(master, master_fd, master_fd, false);
+	sdtp_hal_attach(slave, slave_fd, slave_fd, false);
+
+	return true;
+}
+
+bool sdtp_hal_pair_open(sdtp_hal_linux_t* first, sdtp_hal_linux_t* second) {
+	if (!first || !second) return false;
+
+	int fds[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, fds) != 0) return false;
+
+	sdtp_hal_attach(first, fds[0], fds[0], false);
+	sdtp_hal_attach(second, fds[1], fds[1], false);
+
+	return true;
+}
@@ -0,0 +1,175 @@
+// Copyright (c) 2026 bazelik
+
+#define _GNU_SOURCE
+
+#include "hal_linux.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+// Sets epoll interest of the link
+static bool sdtp_reactor_watch(const sdtp_reactor_t* reactor, sdtp_reactor_link_t* link, const int operation,
+                               const bool want_write) {
+	struct epoll_event event = { 0 };
+	event.events = EPOLLIN | (want_write ? EPOLLOUT : 0u);
+	event.data.ptr = link;
+
+	if (epoll_ctl(reactor->epoll_fd, operation, link->driver->read_fd, &event) != 0) return false;
+
+	link->write_armed = want_write;
+	return true;
+}
+
+bool sdtp_reactor_init(sdtp_reactor_t* reactor) {
+	if (!reactor) return false;
+
+	reactor->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	reactor->link_count = 0;
+	reactor->links = NULL;
+
+	return reactor->epoll_fd >= 0;
+}
+
+void sdtp_reactor_close(sdtp_reactor_t* reactor) {
+	if (!reactor) return;
+
+	if (reactor->epoll_fd >= 0) close(reactor->epoll_fd);
+	reactor->epoll_fd = -1;
+	reactor->link_count = 0;
+	reactor->links = NULL;
+}
+
+bool sdtp_reactor_add(sdtp_reactor_t* reactor, sdtp_reactor_link_t* link) {
+	if (!reactor || !link || !link->instance || !link->driver) return false;
+	if (link->driver->read_fd < 0) return false;
+
+	if (!sdtp_reactor_watch(reactor, link, EPOLL_CTL_ADD, false)) return false;
+
+	link->reactor = reactor;
+	link->registered = true;
+	link->next = reactor->links;
+	reactor->links = link;
+	reactor->link_count++;
+
+	return true;
+}
+
+void sdtp_reactor_remove(sdtp_reactor_t* reactor, sdtp_reactor_link_t* link) {
+	if (!reactor || !link || !link->registered) return;
+
+	epoll_ctl(reactor->epoll_fd, EPOLL_CTL_DEL, link->driver->read_fd, NULL);
+
+	sdtp_reactor_link_t** position = &reactor->links;
+	while (*position && *position != link) position = &(*position)->next;
+	if (*position) *position = link->next;
+	link->next = NULL;
+
+	link->registered = false;
+	link->write_armed = false;
+	reactor->link_count--;
+}
+
+bool sdtp_reactor_update(sdtp_reactor_t* reactor, sdtp_reactor_link_t* link) {
+	if (!reactor || !link || !link->registered) return false;
+
+	// Writable events only while there's something to write, otherwise they fire constantly
+	const bool want_write = sdtp_output_pending(link->instance) > 0;
+	if (want_write == link->write_armed) return true;
+
+	return sdtp_reactor_watch(reactor, link, EPOLL_CTL_MOD, want_write);
+}
+
+// Reads until the descriptor is drained and dispatches every complete packet
+static void sdtp_reactor_service_read(sdtp_reactor_link_t* link) {
+	sdtp_instance_t* instance = link->instance;
+
+	bool more = true;
+	while (more) {
+		more = sdtp_io_read(instance);
+
+		sdtp_packet_view_t view;
+		while (sdtp_read_packet_view(instance, &view)) {
+			if (link->on_packet) {
+				link->on_packet(instance, &view, link->ctx);
+			} else {
+				sdtp_dispatch_view(instance, &view);
+			}
+			sdtp_packet_view_release(instance, &view);
+		}
+	}
+}
+
+// Wait timeout bounded by the earliest timer of any link
+static int sdtp_reactor_wait_timeout(const sdtp_reactor_t* reactor, const int timeout_ms) {
+	uint64_t timer_us = UINT64_MAX;
+	for (const sdtp_reactor_link_t* link = reactor->links; link; link = link->next) {
+		const uint64_t reliable_us = sdtp_reliable_next_timeout(link->instance);
+		const uint64_t reassembly_us = sdtp_reassembly_next_timeout(link->instance);
+
+		if (reliable_us < timer_us) timer_us = reliable_us;
+		if (reassembly_us < timer_us) timer_us = reassembly_us;
+	}
+	if (timer_us == UINT64_MAX) return timeout_ms;
+
+	// Round up, waking early would only spin
+	const uint64_t timer_ms = timer_us / 1000 + (timer_us % 1000 != 0);
+	if (timeout_ms >= 0 && (uint64_t)timeout_ms <= timer_ms) return timeout_ms;
+
+	return timer_ms > INT_MAX ? INT_MAX : (int)timer_ms;
+}
+
+// Runs timers of every link, the idle ones included
+static void sdtp_reactor_service_timers(sdtp_reactor_t* reactor) {
+	sdtp_reactor_link_t* link = reactor->links;
+	while (link) {
+		sdtp_reactor_link_t* next = link->next;
+
+		// Acknowledge what was read, repair what the peer missed
+		sdtp_reliable_poll(link->instance);
+		sdtp_reassembly_expire(link->instance);
+
+		// Retransmits may be left pending by a busy channel
+		sdtp_reactor_update(reactor, link);
+
+		link = next;
+	}
+}
+
+int sdtp_reactor_run_once(sdtp_reactor_t* reactor, const int timeout_ms) {
+	if (!reactor || reactor->epoll_fd < 0) return -1;
+
+	struct epoll_event events[SDTP_REACTOR_MAX_EVENTS];
+	const int count = epoll_wait(reactor->epoll_fd, events, SDTP_REACTOR_MAX_EVENTS,
+	                             sdtp_reactor_wait_timeout(reactor, timeout_ms));
+	if (count < 0) return errno == EINTR ? 0 : -1;
+
+	for (int i = 0; i < count; ++i) {
+		sdtp_reactor_link_t* link = (sdtp_reactor_link_t*)events[i].data.ptr;
+		const uint32_t ready = events[i].events;
+
+		// Hang-up and errors are reported by the next read
+		if (ready & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+			sdtp_reactor_service_read(link);
+
+			if (link->driver->eof) {
+				sdtp_reactor_remove(reactor, link);
+				if (link->on_close) link->on_close(link->instance, link->ctx);
+				continue;
+			}
+		}
+
+		// Writable: pending output can go out without waiting
+		if (ready & EPOLLOUT) {
+			sdtp_flush(link->instance);
+		}
+
+		// Replies written by callbacks may still be pending
+		sdtp_reactor_update(reactor, link);
+	}
+
+	sdtp_reactor_service_timers(reactor);
+
+	return count;
+}
@@ -0,0 +1,32 @@
+// Copyright (c) 2026 bazelik
+
+#define _GNU_SOURCE
+
+#include "hal_linux.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+bool sdtp_hal_replay_open(sdtp_hal_linux_t* driver, const char* input_path, const char* output_path) {
+	if (!driver) return false;
+
+	// Regular files never block, no need for O_NONBLOCK
+	int input_fd = -1;
+	if (input_path) {
+		input_fd = open(input_path, O_RDONLY | O_CLOEXEC);
+		if (input_fd < 0) return false;
+	}
+
+	int output_fd = -1;
+	if (output_path) {
+		output_fd = open(output_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+		if (output_fd < 0) {
+			if (input_fd >= 0) close(input_fd);
+			return false;
+		}
+	}
+
+	sdtp_hal_attach(driver, input_fd, output_fd, true);
+
+	return true;
+}
@@ -0,0 +1,56 @@
+// Copyright (c) 2026 bazelik
+
+#define _GNU_SOURCE
+
+#include "hal_linux.h"
+
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+// Maps baud rate to termios speed (0 if unsupported)
+static speed_t sdtp_hal_baud_to_speed(const uint32_t baud_rate) {
+	switch (baud_rate) {
+		case 1200:    return B1200;
+		case 2400:    return B2400;
+		case 4800:    return B4800;
+		case 9600:    return B9600;
+		case 19200:   return B19200;
+		case 38400:   return B38400;
+		case 57600:   return B57600;
+		case 115200:  return B115200;
+		case 230400:  return B230400;
+		case 460800:  return B460800;
+		case 500000:  return B500000;
+		case 576000:  return B576000;
+		case 921600:  return B921600;
+		case 1000000: return B1000000;
+		case 1152000: return B1152000;
+		case 1500000: return B1500000;
+		case 2000000: return B2000000;
+		case 2500000: return B2500000;
+		case 3000000: return B3000000;
+		case 3500000: return B3500000;
+		case 4000000: return B4000000;
+		default:      return 0;
+	}
+}
+
+bool sdtp_hal_serial_open(sdtp_hal_linux_t* driver, const char* path, const sdtp_config_t* config) {
+	if (!driver || !path || !config) return false;
+
+	const speed_t speed = sdtp_hal_baud_to_speed(config->baud_rate);
+	if (speed == 0) return false;
+
+	const int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+	if (fd < 0) return false;
+
+	if (!sdtp_hal_set_raw(fd, speed)) {
+		close(fd);
+		return false;
+	}
+
+	sdtp_hal_attach(driver, fd, fd, false);
+
+	return true;
+}
@@ -0,0 +1,55 @@
+// Copyright (c) 2026 bazelik
+
+// Input buffer isn't cleared under held views, the parser starts over once it is.
+
+#include "test.h"
+
+int main(void) {
+	const sdtp_config_t config = { 0, 0, 256, 0, NULL, false };
+	static test_wire_t a_out, b_out;
+	const sdtp_function_hooks_v2 a_hooks = test_wire_hooks(&a_out);
+	const sdtp_function_hooks_v2 b_hooks = test_wire_hooks(&b_out);
+
+	sdtp_instance_t* a = sdtp_instance_create_v2(&config, &a_hooks);
+	sdtp_instance_t* b = sdtp_instance_create_v2(&config, &b_hooks);
+	CHECK(a && b);
+
+	const uint8_t payload[20] = { 0x10, 0x20, 0x30 };
+	const sdtp_iovec_t body = { payload, sizeof(payload) };
+	CHECK(sdtp_write_packet_iov(a, &body, 1, SDTP_DATA_PACKET, 1));
+	CHECK(sdtp_write_packet_iov(a, &body, 1, SDTP_DATA_PACKET, 2));
+	CHECK(test_wire_deliver(&a_out, b));
+
+	// Held view keeps its bytes
+	sdtp_packet_view_t view;
+	CHECK(sdtp_read_packet_view(b, &view));
+	CHECK(view.header.id == 1);
+	CHECK(!sdtp_buffer_clear(b, SDTP_INPUT_BUFFER));
+	CHECK(memcmp(view.body, payload, sizeof(payload)) == 0);
+	sdtp_packet_view_release(b, &view);
+
+	// Half a frame is dropped together with the parser progress over it
+	CHECK(sdtp_write_packet_iov(a, &body, 1, SDTP_DATA_PACKET, 3));
+	CHECK(sdtp_io_push(b, a_out.data, a_out.len / 2));
+	a_out.len = 0;
+	CHECK(sdtp_read_packet_view(b, &view));
+	CHECK(view.header.id == 2);
+	sdtp_packet_view_release(b, &view);
+	CHECK(!sdtp_read_packet_view(b, &view));
+
+	CHECK(sdtp_buffer_clear(b, SDTP_INPUT_BUFFER));
+	CHECK(sdtp_buffer_get_used_space(b->input_buffer) == 0);
+	CHECK(b->parser.offset == 0 && b->parser.views == 0 && b->parser.state == SDTP_PARSER_SEEK);
+
+	// Next frame parses from a clean start
+	CHECK(sdtp_write_packet_iov(a, &body, 1, SDTP_DATA_PACKET, 4));
+	CHECK(test_wire_deliver(&a_out, b));
+	CHECK(sdtp_read_packet_view(b, &view));
+	CHECK(view.header.id == 4 && memcmp(view.body, payload, sizeof(payload)) == 0);
+	sdtp_packet_view_release(b, &view);
+
+	sdtp_instance_close(a);
+	sdtp_instance_close(b);
+
+	return 0;
+}
@@ -0,0 +1,134 @@
+// Copyright (c) 2026 bazelik
+
+// Under SDTP_OVERFLOW_GROW a frame larger than the initial buffer is awaited
+// while it arrives in pieces, only frames past the growth limit are garbage.
+
+#include "test.h"
+
+#include <stdlib.h>
+
+#define INITIAL_SIZE 256
+#define MAX_SIZE     4096
+#define PIECE_SIZE   100
+
+// Serialized frames handed out a piece per read
+typedef struct {
+	uint8_t data[3 * MAX_SIZE];
+	size_t len;
+	size_t pos;
+} source_t;
+
+static size_t source_read(void* ctx, uint8_t* buffer, const size_t capacity) {
+	source_t* source = (source_t*)ctx;
+
+	size_t len = source->len - source->pos;
+	if (len > PIECE_SIZE) len = PIECE_SIZE;
+	if (len > capacity) len = capacity;
+
+	memcpy(buffer, source->data + source->pos, len);
+	source->pos += len;
+
+	return len;
+}
+
+static bool source_add(source_t* source, const uint8_t* payload, const size_t len, const uint32_t id) {
+	sdtp_packet_t* packet = sdtp_construct_packet_bytes(payload, len, SDTP_DATA_PACKET, id);
+	if (!packet) return false;
+
+	size_t frame_size = 0;
+	uint8_t* frame = sdtp_serialize_packet(packet, &frame_size);
+	sdtp_packet_free(packet);
+	if (!frame || frame_size > sizeof(source->data) - source->len) {
+		free(frame);
+		return false;
+	}
+
+	memcpy(source->data + source->len, frame, frame_size);
+	source->len += frame_size;
+	free(frame);
+
+	return true;
+}
+
+// Reads until the source is drained, returns the packets in order
+static size_t read_all(sdtp_instance_t* instance, const source_t* source, sdtp_packet_t** packets, const size_t max) {
+	size_t count = 0;
+	for (int i = 0; i < 1000 && count < max; ++i) {
+		sdtp_io_read(instance);
+
+		sdtp_packet_t* packet;
+		while (count < max && (packet = sdtp_read_packet(instance, SDTP_READ_PARTIAL)) != NULL) {
+			packets[count++] = packet;
+		}
+		if (source->pos == source->len && sdtp_buffer_get_used_space(instance->input_buffer) == 0) break;
+	}
+
+	return count;
+}
+
+int main(void) {
+	const sdtp_config_t config = { 0, 0, INITIAL_SIZE, 0, NULL, false };
+
+	static uint8_t large[MAX_SIZE];
+	for (size_t i = 0; i < sizeof(large); ++i) large[i] = (uint8_t)(i * 7 + 3);
+	const uint8_t small[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+
+	static source_t source;
+	const sdtp_function_hooks_v2 hooks = { &source, source_read, test_wire_writev };
+
+	// Legacy policy stays the default
+	sdtp_instance_t* instance = sdtp_instance_create_v2(&config, &hooks);
+	CHECK(instance);
+	CHECK(instance->input_buffer->overflow == SDTP_OVERFLOW_WIPE);
+
+	// Frame of several initial buffers, then a small one behind it
+	sdtp_buffer_set_overflow(instance->input_buffer, SDTP_OVERFLOW_GROW, MAX_SIZE);
+	CHECK(sdtp_buffer_get_max_frame(instance->input_buffer) == MAX_SIZE);
+	CHECK(source_add(&source, large, 1500, 1));
+	CHECK(source_add(&source, small, sizeof(small), 2));
+
+	sdtp_packet_t* packets[2] = { NULL, NULL };
+	CHECK(read_all(instance, &source, packets, 2) == 2);
+	CHECK(packets[0]->header.id == 1 && packets[0]->header.data_size == 1500);
+	CHECK(memcmp(packets[0]->body, large, 1500) == 0);
+	CHECK(packets[1]->header.id == 2 && packets[1]->header.data_size == sizeof(small));
+	CHECK(instance->input_buffer->size == 2048);
+	sdtp_packet_free(packets[0]);
+	sdtp_packet_free(packets[1]);
+
+	// Frame past the growth limit is garbage, the next one still arrives
+	source.len = 0;
+	source.pos = 0;
+	CHECK(source_add(&source, large, MAX_SIZE, 3));
+	CHECK(source_add(&source, small, sizeof(small), 4));
+
+	packets[0] = NULL;
+	CHECK(read_all(instance, &source, packets, 1) == 1);
+	CHECK(packets[0]->header.id == 4);
+	CHECK(instance->input_buffer->size <= MAX_SIZE);
+	sdtp_packet_free(packets[0]);
+	sdtp_instance_close(instance);
+
+	// Pushed pieces grow the buffer too
+	instance = sdtp_instance_create_v2(&config, &hooks);
+	CHECK(instance);
+	sdtp_buffer_set_overflow(instance->input_buffer, SDTP_OVERFLOW_GROW, MAX_SIZE);
+	source.len = 0;
+	source.pos = 0;
+	CHECK(source_add(&source, large, 1000, 5));
+
+	// Reads find the source drained, bytes come only from pushes
+	source.pos = source.len;
+	for (size_t pos = 0; pos < source.len; pos += PIECE_SIZE) {
+		const size_t len = source.len - pos < PIECE_SIZE ? source.len - pos : PIECE_SIZE;
+		CHECK(sdtp_io_push(instance, source.data + pos, len));
+		if (pos + len < source.len) CHECK(sdtp_read_packet(instance, SDTP_READ_PEEK) == NULL);
+	}
+
+	sdtp_packet_t* packet = sdtp_read_packet(instance, SDTP_READ_PARTIAL);
+	CHECK(packet && packet->header.id == 5 && memcmp(packet->body, large, 1000) == 0);
+	sdtp_packet_free(packet);
+	sdtp_instance_close(instance);
+
+	return 0;
+}
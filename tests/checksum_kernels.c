@@ -0,0 +1,125 @@
+// Copyright (c) 2026 bazelik
+
+// Every Fletcher-32 kernel the CPU supports gives the checksum of a plain
+// reference, for any length, alignment and split of the data.
+
+#include "test.h"
+
+#define MAX_SHORT_LEN 1100
+#define MAX_OFFSET    32
+
+// Lengths past the 360-word scalar block and the vector block limits
+static const size_t long_lens[] = { 8191, 8192, 8193, 16384 + 37, 65535, 65536, 200001 };
+
+static uint8_t data[200001 + MAX_OFFSET];
+static uint8_t copy[200001 + MAX_OFFSET];
+
+// Sums reduced after every word, odd last byte is a word of its own
+static uint32_t reference(const uint8_t* bytes, const size_t len) {
+	uint32_t c0 = 0, c1 = 0;
+
+	size_t i = 0;
+	for (; i + 1 < len; i += 2) {
+		uint16_t word;
+		memcpy(&word, bytes + i, sizeof(word));
+		c0 = (c0 + word) % 65535;
+		c1 = (c1 + c0) % 65535;
+	}
+	if (i < len) {
+		c0 = (c0 + bytes[i]) % 65535;
+		c1 = (c1 + c0) % 65535;
+	}
+
+	return c1 << 16 | c0;
+}
+
+// Same data through updates of varying size, odd ones included
+static uint32_t chunked(const uint8_t* bytes, const size_t len, size_t step) {
+	sdtp_fletcher32_state_t state;
+	sdtp_fletcher32_init(&state);
+
+	size_t done = 0;
+	while (done < len) {
+		size_t chunk = len - done < step ? len - done : step;
+		sdtp_fletcher32_update(&state, bytes + done, chunk);
+		done += chunk;
+		step = step * 3 % 97 + 1;
+	}
+
+	return sdtp_fletcher32_final(&state);
+}
+
+static int check_kernel(const char* name) {
+	// Short lengths at every alignment
+	for (size_t offset = 0; offset < MAX_OFFSET; ++offset) {
+		for (size_t len = 0; len <= MAX_SHORT_LEN; ++len) {
+			const uint8_t* bytes = data + offset;
+			const uint32_t expected = reference(bytes, len);
+
+			if (sdtp_calculate_fletcher32(bytes, len) != expected || chunked(bytes, len, offset + 1) != expected) {
+				fprintf(stderr, "%s: len %zu offset %zu\n", name, len, offset);
+				return 1;
+			}
+		}
+	}
+
+	// Long lengths, misaligned and split
+	for (size_t i = 0; i < sizeof(long_lens) / sizeof(long_lens[0]); ++i) {
+		for (size_t offset = 0; offset < 3; ++offset) {
+			const uint8_t* bytes = data + offset;
+			const size_t len = long_lens[i];
+			const uint32_t expected = reference(bytes, len);
+
+			CHECK(sdtp_calculate_fletcher32(bytes, len) == expected);
+			CHECK(chunked(bytes, len, 7) == expected);
+			CHECK(sdtp_copy_fletcher32(copy + offset, bytes, len) == expected);
+			CHECK(memcmp(copy + offset, bytes, len) == 0);
+			CHECK(sdtp_verify_fletcher32(bytes, len, expected));
+		}
+	}
+
+	return 0;
+}
+
+// Runs every kernel on data of the current pattern
+static int check_all(void) {
+	static const struct {
+		sdtp_checksum_kernel_t kernel;
+		const char* name;
+	} kernels[] = {
+		{ SDTP_CHECKSUM_SCALAR, "scalar" },
+		{ SDTP_CHECKSUM_SSE2, "sse2" },
+		{ SDTP_CHECKSUM_AVX2, "avx2" },
+		{ SDTP_CHECKSUM_NEON, "neon" },
+		{ SDTP_CHECKSUM_AUTO, "auto" },
+	};
+
+	for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); ++i) {
+		if (!sdtp_checksum_set_kernel(kernels[i].kernel)) {
+			printf("%s: not supported\n", kernels[i].name);
+			continue;
+		}
+		if (check_kernel(kernels[i].name) != 0) return 1;
+	}
+
+	return 0;
+}
+
+int main(void) {
+	// Scalar is always there
+	CHECK(sdtp_checksum_set_kernel(SDTP_CHECKSUM_SCALAR));
+
+	// All ones push the lane sums to their limits
+	memset(data, 0xFF, sizeof(data));
+	CHECK(check_all() == 0);
+
+	// Pseudo-random bytes
+	uint32_t seed = 12345;
+	for (size_t i = 0; i < sizeof(data); ++i) {
+		seed = seed * 1103515245u + 12345u;
+		data[i] = (uint8_t)(seed >> 16);
+	}
+	CHECK(check_all() == 0);
+
+	return 0;
+}
@@ -0,0 +1,97 @@
+// Copyright (c) 2026 bazelik
+
+// Compact frames are taken only once both ends negotiated the compact header,
+// ids that don't fit its id width go out with the full header.
+
+#include "test.h"
+
+#include <stdlib.h>
+
+static size_t received;
+static uint32_t last_id;
+
+static void on_data(sdtp_instance_t* instance, const sdtp_packet_view_t* view, void* ctx) {
+	(void)instance;
+	(void)ctx;
+
+	received++;
+	last_id = view->header.id;
+}
+
+int main(void) {
+	const sdtp_config_t config = { 0, 0, 1024, 0, NULL, false };
+	const sdtp_header_format_t format = { 0, 2 };
+
+	static test_wire_t a_out, b_out;
+	const sdtp_function_hooks_v2 a_hooks = test_wire_hooks(&a_out);
+	const sdtp_function_hooks_v2 b_hooks = test_wire_hooks(&b_out);
+
+	sdtp_instance_t* a = sdtp_instance_create_v2(&config, &a_hooks);
+	sdtp_instance_t* b = sdtp_instance_create_v2(&config, &b_hooks);
+	CHECK(a && b);
+	CHECK(sdtp_instance_set_header_format(a, &format));
+	CHECK(sdtp_instance_set_header_format(b, &format));
+	CHECK(sdtp_set_handler(b, SDTP_DATA_PACKET, on_data, NULL));
+
+	const uint8_t payload[32] = { 0x11, 0x22, 0x33 };
+
+	// Compact frame before the handshake is garbage, the full frame behind it isn't
+	sdtp_packet_t* packet = sdtp_construct_packet_bytes(payload, sizeof(payload), SDTP_DATA_PACKET, 0);
+	CHECK(packet);
+	size_t frame_size = 0;
+	uint8_t* frame = sdtp_serialize_packet_compact(packet, &format, &frame_size);
+	CHECK(frame && frame[0] == SDTP_START_OF_COMPACT);
+	CHECK(sdtp_io_push(b, frame, frame_size));
+	free(frame);
+	sdtp_packet_free(packet);
+
+	CHECK(sdtp_write_packet_iov(a, &(sdtp_iovec_t){ payload, sizeof(payload) }, 1, SDTP_DATA_PACKET, 1));
+	CHECK(a_out.data[0] == SDTP_START_OF_HEADER);
+	CHECK(test_wire_deliver(&a_out, b));
+	sdtp_dispatch(b);
+	CHECK(received == 1 && last_id == 1);
+
+	// Negotiate
+	CHECK(sdtp_link_connect(a, 2));
+	CHECK(test_wire_deliver(&a_out, b));
+	sdtp_dispatch(b);
+	CHECK(test_wire_deliver(&b_out, a));
+	sdtp_dispatch(a);
+	CHECK(sdtp_link_get_features(a) & SDTP_FEATURE_COMPACT_HEADER);
+	CHECK(sdtp_link_get_features(b) & SDTP_FEATURE_COMPACT_HEADER);
+
+	// Id 0 fits a zero width id
+	CHECK(sdtp_write_packet_iov(a, &(sdtp_iovec_t){ payload, sizeof(payload) }, 1, SDTP_DATA_PACKET, 0));
+	CHECK(a_out.data[0] == SDTP_START_OF_COMPACT);
+	CHECK(test_wire_deliver(&a_out, b));
+	sdtp_dispatch(b);
+	CHECK(received == 2 && last_id == 0);
+
+	// Other ids fall back to the full header instead of losing the id
+	CHECK(sdtp_write_packet_iov(a, &(sdtp_iovec_t){ payload, sizeof(payload) }, 1, SDTP_DATA_PACKET, 7));
+	CHECK(a_out.data[0] == SDTP_START_OF_HEADER);
+	CHECK(test_wire_deliver(&a_out, b));
+	sdtp_dispatch(b);
+	CHECK(received == 3 && last_id == 7);
+
+	// Compact frames are garbage again once the link is down
+	CHECK(sdtp_link_disconnect(a, 3));
+	CHECK(test_wire_deliver(&a_out, b));
+	sdtp_dispatch(b);
+	CHECK(sdtp_link_get_features(b) == 0);
+
+	packet = sdtp_construct_packet_bytes(payload, sizeof(payload), SDTP_DATA_PACKET, 0);
+	CHECK(packet);
+	frame = sdtp_serialize_packet_compact(packet, &format, &frame_size);
+	CHECK(frame);
+	CHECK(sdtp_io_push(b, frame, frame_size));
+	free(frame);
+	sdtp_packet_free(packet);
+	sdtp_dispatch(b);
+	CHECK(received == 3);
+
+	sdtp_instance_close(a);
+	sdtp_instance_close(b);
+
+	return 0;
+}
@@ -0,0 +1,257 @@
+// Copyright (c) 2026 bazelik
+
+// Compressed payloads come back bit-identical, broken streams and sizes the
+// stream can't produce are refused, and packets are compressed or decoded
+// only once both ends negotiated compression.
+
+#include "test.h"
+
+#include <stdlib.h>
+
+static size_t received;
+static uint8_t last_body[4096];
+static uint32_t last_size;
+
+static void on_data(sdtp_instance_t* instance, const sdtp_packet_view_t* view, void* ctx) {
+	(void)instance;
+	(void)ctx;
+
+	received++;
+	last_size = view->header.data_size;
+	if (last_size <= sizeof(last_body)) memcpy(last_body, view->body, last_size);
+}
+
+// Counts allocations, so refused sizes can be shown to cost nothing
+static size_t allocations;
+
+static void* counting_alloc(void* ctx, const size_t size) {
+	(void)ctx;
+
+	allocations++;
+	return malloc(size);
+}
+
+static void counting_free(void* ctx, void* ptr, const size_t size) {
+	(void)ctx;
+	(void)size;
+
+	free(ptr);
+}
+
+static const sdtp_allocator_t counting = { counting_alloc, counting_free, NULL };
+
+// Compressed frame view over body (size prefix, then the stream)
+static sdtp_packet_view_t compressed_view(const uint8_t* body, const size_t body_size) {
+	const sdtp_packet_header_t header = { 7, (uint32_t)body_size, (uint32_t)SDTP_DATA_PACKET | SDTP_TYPE_COMPRESSED, 0 };
+
+	return (sdtp_packet_view_t){ header, body, 0 };
+}
+
+// Compresses source behind its size prefix (0 - didn't compress)
+static size_t compress_body(const uint8_t* source, const size_t source_len, uint8_t* body, const size_t capacity) {
+	static uint32_t table[SDTP_COMPRESS_TABLE_SIZE];
+
+	const uint32_t size = (uint32_t)source_len;
+	memcpy(body, &size, SDTP_COMPRESS_PREFIX_SIZE);
+
+	const size_t stream_len = sdtp_compress(source, source_len, body + SDTP_COMPRESS_PREFIX_SIZE,
+	                                        capacity - SDTP_COMPRESS_PREFIX_SIZE, table);
+
+	return stream_len ? SDTP_COMPRESS_PREFIX_SIZE + stream_len : 0;
+}
+
+// Whether body decodes to source, whole and fed byte by byte
+static bool round_trip(const uint8_t* source, const size_t source_len, const uint8_t* body, const size_t body_size) {
+	const sdtp_packet_view_t view = compressed_view(body, body_size);
+	sdtp_packet_t* packet = sdtp_decompress_packet(NULL, &view, 0);
+	if (!packet) return false;
+
+	const bool whole = packet->header.data_size == source_len && packet->header.id == 7 &&
+	                   packet->header.type == SDTP_DATA_PACKET && memcmp(packet->body, source, source_len) == 0;
+	sdtp_packet_free(packet);
+
+	uint8_t out[4096];
+	sdtp_decompressor_t decompressor;
+	sdtp_decompressor_init(&decompressor, out, source_len);
+	for (size_t i = SDTP_COMPRESS_PREFIX_SIZE; i < body_size; ++i) {
+		if (!sdtp_decompressor_update(&decompressor, body + i, 1)) return false;
+	}
+
+	return whole && sdtp_decompressor_done(&decompressor) && memcmp(out, source, source_len) == 0;
+}
+
+// Whether the frame is refused
+static bool refused(const uint8_t* body, const size_t body_size, const size_t max_size) {
+	const sdtp_packet_view_t view = compressed_view(body, body_size);
+	sdtp_packet_t* packet = sdtp_decompress_packet(&counting, &view, max_size);
+	if (packet) {
+		sdtp_packet_free(packet);
+		return false;
+	}
+
+	return true;
+}
+
+int main(void) {
+	static uint8_t source[4096];
+	static uint8_t body[4096 + 64];
+
+	// Repetitive text, long runs (length continuation bytes) and noise
+	for (size_t i = 0; i < 1500; ++i) source[i] = (uint8_t)"sdtp frame payload "[i % 19];
+	memset(source + 1500, 0xAB, 1200);
+	uint32_t state = 12345;
+	for (size_t i = 2700; i < sizeof(source); ++i) {
+		state = state * 1103515245u + 12345u;
+		source[i] = (uint8_t)(state >> 16);
+	}
+
+	// Round trip
+	const size_t sizes[] = { 16, 19, 64, 300, 1500, 2700, 3000, sizeof(source) };
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+		const size_t body_size = compress_body(source, sizes[i], body, sizeof(body));
+		CHECK(body_size > 0);
+		CHECK(round_trip(source, sizes[i], body, body_size));
+	}
+
+	// Noise doesn't fit a stream smaller than itself
+	CHECK(compress_body(source + 2700, 1000, body, 1000) == 0);
+
+	const size_t body_size = compress_body(source, 2700, body, sizeof(body));
+	CHECK(body_size > 0 && body_size < 200);
+
+	// Truncated anywhere
+	for (size_t cut = 0; cut < body_size; ++cut) {
+		CHECK(refused(body, cut, 0));
+	}
+
+	// Input past the end of the payload
+	body[body_size] = 0x10;
+	CHECK(refused(body, body_size + 1, 0));
+
+	// Match before the start of the payload
+	const uint8_t far_match[] = { 5, 0, 0, 0, 0x10, 'x', 0x02, 0x00 };
+	CHECK(refused(far_match, sizeof(far_match), 0));
+
+	// Zero offset
+	const uint8_t zero_offset[] = { 5, 0, 0, 0, 0x10, 'x', 0x00, 0x00 };
+	CHECK(refused(zero_offset, sizeof(zero_offset), 0));
+
+	// Literals longer than the payload
+	const uint8_t long_literals[] = { 4, 0, 0, 0, 0x50, 'a', 'b', 'c', 'd', 'e' };
+	CHECK(refused(long_literals, sizeof(long_literals), 0));
+
+	// Match longer than the payload
+	const uint8_t long_match[] = { 8, 0, 0, 0, 0x1F, 'x', 0x01, 0x00, 0x10 };
+	CHECK(refused(long_match, sizeof(long_match), 0));
+
+	// Same stream for the payload it was made for
+	const uint8_t fitting_match[] = { 8, 0, 0, 0, 0x13, 'x', 0x01, 0x00 };
+	CHECK(!refused(fitting_match, sizeof(fitting_match), 0));
+
+	// Prefix larger than what the stream decodes to
+	uint32_t size = 2701;
+	memcpy(body, &size, SDTP_COMPRESS_PREFIX_SIZE);
+	CHECK(refused(body, body_size, 0));
+
+	// Size limit of the receiver is checked before anything is allocated
+	size = 2700;
+	memcpy(body, &size, SDTP_COMPRESS_PREFIX_SIZE);
+	allocations = 0;
+	CHECK(refused(body, body_size, 2699));
+	CHECK(allocations == 0);
+	CHECK(!refused(body, body_size, 2700));
+	CHECK(allocations == 1);
+
+	// So is a size the stream can't expand to
+	const uint8_t huge[] = { 0xF0, 0xFF, 0xFF, 0xFF, 0xF0, 0xFF, 0xFF, 0xFF, 0xFF };
+	allocations = 0;
+	CHECK(refused(huge, sizeof(huge), 0));
+	CHECK(allocations == 0);
+
+	uint8_t run[8] = { 0, 0, 0, 0, 0xF0, 0xFF, 0xFF, 0x00 };
+	size = 4 * SDTP_COMPRESS_MAX_RATIO + 1;
+	memcpy(run, &size, SDTP_COMPRESS_PREFIX_SIZE);
+	CHECK(refused(run, sizeof(run), 0));
+	CHECK(allocations == 0);
+
+	// Negotiation
+	const sdtp_config_t config = { 0, 0, 4096, 0, NULL, false };
+
+	static test_wire_t a_out, b_out;
+	const sdtp_function_hooks_v2 a_hooks = test_wire_hooks(&a_out);
+	const sdtp_function_hooks_v2 b_hooks = test_wire_hooks(&b_out);
+
+	sdtp_instance_t* a = sdtp_instance_create_v2(&config, &a_hooks);
+	sdtp_instance_t* b = sdtp_instance_create_v2(&config, &b_hooks);
+	CHECK(a && b);
+	CHECK(sdtp_instance_set_compression(a, true, NULL));
+	CHECK(sdtp_instance_set_compression(b, true, NULL));
+	CHECK(sdtp_set_handler(b, SDTP_DATA_PACKET, on_data, NULL));
+
+	// Not compressed before the handshake
+	CHECK(sdtp_write_packet_iov(a, &(sdtp_iovec_t){ source, 1500 }, 1, SDTP_DATA_PACKET, 1));
+	CHECK(a->compression.compressed == 0);
+	CHECK(a_out.len > 1500);
+	CHECK(test_wire_deliver(&a_out, b));
+	sdtp_dispatch(b);
+	CHECK(received == 1 && last_size == 1500);
+
+	// Compressed frame from a peer which didn't negotiate is dropped
+	const size_t frame_body_size = compress_body(source, 1500, body, sizeof(body));
+	CHECK(frame_body_size > 0);
+	sdtp_packet_t* packet = sdtp_construct_packet_bytes(body, frame_body_size,
+	                                                    (sdtp_packet_type_t)((uint32_t)SDTP_DATA_PACKET | SDTP_TYPE_COMPRESSED), 2);
+	CHECK(packet);
+	size_t frame_size = 0;
+	uint8_t* frame = sdtp_serialize_packet(packet, &frame_size);
+	CHECK(frame);
+	CHECK(sdtp_io_push(b, frame, frame_size));
+	sdtp_dispatch(b);
+	CHECK(received == 1);
+
+	CHECK(sdtp_io_push(b, frame, frame_size));
+	CHECK(sdtp_read_packet(b, SDTP_READ_PARTIAL) == NULL);
+
+	// Negotiate
+	CHECK(sdtp_link_connect(a, 3));
+	CHECK(test_wire_deliver(&a_out, b));
+	sdtp_dispatch(b);
+	CHECK(test_wire_deliver(&b_out, a));
+	sdtp_dispatch(a);
+	CHECK(sdtp_link_get_features(a) & SDTP_FEATURE_COMPRESSION);
+	CHECK(sdtp_link_get_features(b) & SDTP_FEATURE_COMPRESSION);
+
+	// Same frame is decoded now
+	CHECK(sdtp_io_push(b, frame, frame_size));
+	sdtp_dispatch(b);
+	CHECK(received == 2 && last_size == 1500 && memcmp(last_body, source, 1500) == 0);
+
+	CHECK(sdtp_io_push(b, frame, frame_size));
+	sdtp_packet_t* read = sdtp_read_packet(b, SDTP_READ_PARTIAL);
+	CHECK(read && read->header.id == 2 && read->header.type == SDTP_DATA_PACKET);
+	CHECK(read->header.data_size == 1500 && memcmp(read->body, source, 1500) == 0);
+	sdtp_packet_free(read);
+	free(frame);
+	sdtp_packet_free(packet);
+
+	// Writes compress now, the peer gets the payload back
+	CHECK(sdtp_write_packet_iov(a, &(sdtp_iovec_t){ source, 1500 }, 1, SDTP_DATA_PACKET, 4));
+	CHECK(a->compression.compressed == 1);
+	CHECK(a_out.len < 200);
+	CHECK(test_wire_deliver(&a_out, b));
+	sdtp_dispatch(b);
+	CHECK(received == 3 && last_size == 1500 && memcmp(last_body, source, 1500) == 0);
+
+	// Scattered payload is gathered first
+	const sdtp_iovec_t pieces[3] = { { source, 500 }, { source + 500, 700 }, { source + 1200, 1300 } };
+	CHECK(sdtp_write_packet_iov(a, pieces, 3, SDTP_DATA_PACKET, 5));
+	CHECK(a->compression.compressed == 2);
+	CHECK(test_wire_deliver(&a_out, b));
+	sdtp_dispatch(b);
+	CHECK(received == 4 && last_size == 2500 && memcmp(last_body, source, 2500) == 0);
+
+	sdtp_instance_close(a);
+	sdtp_instance_close(b);
+
+	return 0;
+}
@@ -0,0 +1,153 @@
+// Copyright (c) 2026 bazelik
+
+// Two gateway workers over socket pairs: links with their own callback are
+// refused, packets are handed off with their link, and a worker pool that
+// runs dry falls back to the heap until released blocks come back.
+
+#define _GNU_SOURCE
+
+#include "test.h"
+
+#include <hal/libsdtp_hal_linux.h>
+
+#include <time.h>
+
+#define LINKS 2
+#define POOL_BLOCKS 2
+#define BURST 5
+
+static void sleep_ms(const long ms) {
+	const struct timespec delay = { 0, ms * 1000000L };
+	nanosleep(&delay, NULL);
+}
+
+// Polls a worker until count items arrived or a second passed
+static size_t poll_items(sdtp_gateway_t* gateway, const size_t worker, sdtp_gateway_item_t* items, const size_t count) {
+	size_t taken = 0;
+	for (int attempt = 0; attempt < 1000 && taken < count; ++attempt) {
+		taken += sdtp_gateway_poll(gateway, worker, items + taken, count - taken);
+		if (taken < count) sleep_ms(1);
+	}
+
+	return taken;
+}
+
+static bool in_pool(const sdtp_gateway_t* gateway, const size_t worker, const sdtp_packet_t* packet) {
+	const sdtp_pool_class_t* pool_class = &gateway->workers[worker].pool.classes[0];
+
+	return (const uint8_t*)packet >= pool_class->start && (const uint8_t*)packet < pool_class->end;
+}
+
+static void on_packet(sdtp_instance_t* instance, const sdtp_packet_view_t* view, void* ctx) {
+	(void)instance;
+	(void)view;
+	(void)ctx;
+}
+
+static void on_close(sdtp_instance_t* instance, void* ctx) {
+	(void)instance;
+	(void)ctx;
+}
+
+int main(void) {
+	const sdtp_config_t config = { 0, 0, 4096, 0, NULL, false };
+	const size_t block_sizes[1] = { 256 };
+	const size_t block_counts[1] = { POOL_BLOCKS };
+	const sdtp_gateway_config_t gateway_config = { LINKS, false, 0, 64, block_sizes, block_counts, 1 };
+
+	sdtp_gateway_t gateway;
+	CHECK(sdtp_gateway_init(&gateway, &gateway_config));
+
+	sdtp_hal_linux_t local[LINKS], peer[LINKS];
+	sdtp_instance_t* instances[LINKS];
+	sdtp_instance_t* senders[LINKS];
+	sdtp_reactor_link_t links[LINKS];
+	for (size_t i = 0; i < LINKS; ++i) {
+		CHECK(sdtp_hal_pair_open(&local[i], &peer[i]));
+		instances[i] = sdtp_instance_create_v2(&config, sdtp_hal_hooks(&local[i]));
+		senders[i] = sdtp_instance_create_v2(&config, sdtp_hal_hooks(&peer[i]));
+		CHECK(instances[i] && senders[i]);
+	}
+
+	// Callback or ctx of the caller would be lost
+	int marker = 0;
+	links[0] = (sdtp_reactor_link_t){ .instance = instances[0], .driver = &local[0], .ctx = &marker, .on_close = on_close };
+	CHECK(sdtp_gateway_add(&gateway, &links[0]) == -1);
+	CHECK(links[0].ctx == &marker && links[0].on_packet == NULL && links[0].worker == NULL);
+
+	links[0] = (sdtp_reactor_link_t){ .instance = instances[0], .driver = &local[0], .on_packet = on_packet };
+	CHECK(sdtp_gateway_add(&gateway, &links[0]) == -1);
+	CHECK(links[0].on_packet == on_packet && links[0].ctx == NULL);
+
+	// Each link goes to the least loaded worker
+	for (size_t i = 0; i < LINKS; ++i) {
+		links[i] = (sdtp_reactor_link_t){ .instance = instances[i], .driver = &local[i] };
+		CHECK(sdtp_gateway_add(&gateway, &links[i]) == (int)i);
+		CHECK(links[i].worker == &gateway.workers[i]);
+	}
+	CHECK(sdtp_gateway_start(&gateway));
+
+	// More packets than pool blocks, nothing released yet
+	for (size_t i = 0; i < LINKS; ++i) {
+		for (uint32_t id = 0; id < BURST; ++id) {
+			const uint8_t payload[3] = { (uint8_t)i, (uint8_t)id, 0x77 };
+			CHECK(sdtp_write_packet_iov(senders[i], &(sdtp_iovec_t){ payload, sizeof(payload) }, 1, SDTP_DATA_PACKET, id));
+		}
+	}
+
+	sdtp_gateway_item_t items[LINKS][BURST];
+	for (size_t i = 0; i < LINKS; ++i) {
+		CHECK(poll_items(&gateway, i, items[i], BURST) == BURST);
+
+		size_t pooled = 0;
+		for (uint32_t id = 0; id < BURST; ++id) {
+			const sdtp_packet_t* packet = items[i][id].packet;
+			CHECK(items[i][id].link == &links[i]);
+			CHECK(packet->header.id == id && packet->header.data_size == 3);
+			CHECK(packet->body[0] == i && packet->body[1] == id && packet->body[2] == 0x77);
+			if (in_pool(&gateway, i, packet)) pooled++;
+		}
+
+		// Pool blocks first, then the heap
+		CHECK(pooled == POOL_BLOCKS);
+		CHECK(in_pool(&gateway, i, items[i][0].packet) && !in_pool(&gateway, i, items[i][BURST - 1].packet));
+
+		sdtp_gateway_stats_t stats;
+		CHECK(sdtp_gateway_get_stats(&gateway, i, &stats));
+		CHECK(stats.links == 1 && stats.packets == BURST && stats.bytes == BURST * 3 && stats.dropped == 0);
+	}
+
+	// Released packets go back to the worker which decoded them
+	for (size_t i = 0; i < LINKS; ++i) {
+		for (size_t id = 0; id < BURST; ++id) sdtp_gateway_release(&gateway, i, items[i][id].packet);
+	}
+
+	// Worker frees returns before its next wait
+	sleep_ms(5 * SDTP_GATEWAY_POLL_MS);
+
+	for (size_t i = 0; i < LINKS; ++i) {
+		for (uint32_t id = 0; id < POOL_BLOCKS; ++id) {
+			const uint8_t payload[3] = { (uint8_t)i, (uint8_t)id, 0x77 };
+			CHECK(sdtp_write_packet_iov(senders[i], &(sdtp_iovec_t){ payload, sizeof(payload) }, 1, SDTP_DATA_PACKET, id));
+		}
+	}
+
+	for (size_t i = 0; i < LINKS; ++i) {
+		CHECK(poll_items(&gateway, i, items[i], POOL_BLOCKS) == POOL_BLOCKS);
+		for (size_t id = 0; id < POOL_BLOCKS; ++id) {
+			CHECK(in_pool(&gateway, i, items[i][id].packet));
+			sdtp_gateway_release(&gateway, i, items[i][id].packet);
+		}
+	}
+
+	sdtp_gateway_destroy(&gateway);
+
+	for (size_t i = 0; i < LINKS; ++i) {
+		sdtp_instance_close(instances[i]);
+		sdtp_instance_close(senders[i]);
+		sdtp_hal_close(&local[i]);
+		sdtp_hal_close(&peer[i]);
+	}
+
+	return 0;
+}
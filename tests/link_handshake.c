@@ -0,0 +1,122 @@
+// Copyright (c) 2026 bazelik
+
+// Every handshake request is answered, so a lost reply is repaired by asking
+// again, and a restarted peer gets a reply and fresh sequences.
+
+#include "test.h"
+
+static size_t received;
+static uint32_t last_id;
+
+static void on_data(sdtp_instance_t* instance, const sdtp_packet_view_t* view, void* ctx) {
+	(void)instance;
+	(void)ctx;
+
+	received++;
+	last_id = view->header.id;
+}
+
+// Reliable link end which advertises compression
+static sdtp_instance_t* open_end(const sdtp_function_hooks_v2* hooks) {
+	const sdtp_config_t config = { 0, 0, 4096, 0, NULL, false };
+	const sdtp_reliable_config_t reliable = { 8, 0, 100000, 10000, 1000000, 0 };
+
+	sdtp_instance_t* instance = sdtp_instance_create_v2(&config, hooks);
+	if (!instance) return NULL;
+
+	if (!sdtp_instance_set_compression(instance, true, NULL) ||
+	    !sdtp_instance_set_reliable(instance, &reliable, NULL)) {
+		sdtp_instance_close(instance);
+		return NULL;
+	}
+
+	return instance;
+}
+
+int main(void) {
+	static test_wire_t a_out, b_out;
+	const sdtp_function_hooks_v2 a_hooks = test_wire_hooks(&a_out);
+	const sdtp_function_hooks_v2 b_hooks = test_wire_hooks(&b_out);
+
+	sdtp_instance_t* a = open_end(&a_hooks);
+	sdtp_instance_t* b = open_end(&b_hooks);
+	CHECK(a && b);
+	CHECK(sdtp_set_handler(b, SDTP_DATA_PACKET, on_data, NULL));
+
+	// First reply is lost
+	CHECK(sdtp_link_connect(a, 1));
+	CHECK(test_wire_deliver(&a_out, b));
+	sdtp_dispatch(b);
+	CHECK(sdtp_link_get_state(b) == SDTP_LINK_UP);
+	CHECK(b_out.len > 0);
+	b_out.len = 0;
+
+	sdtp_dispatch(a);
+	CHECK(sdtp_link_get_state(a) == SDTP_LINK_CONNECTING);
+	CHECK(sdtp_link_get_features(a) == 0);
+
+	// Retry is answered although the responder is up already
+	CHECK(sdtp_link_connect(a, 2));
+	CHECK(test_wire_deliver(&a_out, b));
+	sdtp_dispatch(b);
+	CHECK(b_out.len > 0);
+	CHECK(test_wire_deliver(&b_out, a));
+	sdtp_dispatch(a);
+	CHECK(sdtp_link_get_state(a) == SDTP_LINK_UP);
+	CHECK(sdtp_link_get_features(a) == SDTP_FEATURE_COMPRESSION);
+	CHECK(sdtp_link_get_features(b) == SDTP_FEATURE_COMPRESSION);
+
+	// Replies are never answered
+	CHECK(a_out.len == 0);
+
+	// Reliable traffic starts from the same sequences on both ends
+	const uint8_t payload[16] = { 0x42 };
+	const sdtp_iovec_t body = { payload, sizeof(payload) };
+	for (uint32_t id = 10; id < 13; ++id) {
+		CHECK(sdtp_write_reliable_iov(a, &body, 1, SDTP_DATA_PACKET, id));
+	}
+	CHECK(test_wire_deliver(&a_out, b));
+	sdtp_dispatch(b);
+	CHECK(received == 3 && last_id == 12);
+	sdtp_reliable_poll(b);
+	CHECK(test_wire_deliver(&b_out, a));
+	sdtp_dispatch(a);
+	CHECK(sdtp_reliable_in_flight(a) == 0);
+
+	// Restarted peer: new instance, sequences from zero
+	sdtp_instance_close(a);
+	a = open_end(&a_hooks);
+	CHECK(a);
+	CHECK(sdtp_link_connect(a, 3));
+	CHECK(test_wire_deliver(&a_out, b));
+	sdtp_dispatch(b);
+	CHECK(b_out.len > 0);
+	CHECK(test_wire_deliver(&b_out, a));
+	sdtp_dispatch(a);
+	CHECK(sdtp_link_get_state(a) == SDTP_LINK_UP);
+
+	// Without the reset the responder would drop these as duplicates
+	CHECK(sdtp_write_reliable_iov(a, &body, 1, SDTP_DATA_PACKET, 20));
+	CHECK(test_wire_deliver(&a_out, b));
+	sdtp_dispatch(b);
+	CHECK(received == 4 && last_id == 20);
+
+	// Stray reply doesn't bring a down link up
+	CHECK(sdtp_link_disconnect(a, 4));
+	CHECK(test_wire_deliver(&a_out, b));
+	sdtp_dispatch(b);
+	CHECK(sdtp_link_get_state(b) == SDTP_LINK_DOWN);
+	b_out.len = 0;
+
+	const uint32_t reply = SDTP_HANDSHAKE_REPLY;
+	CHECK(sdtp_write_packet_iov(a, &(sdtp_iovec_t){ (const uint8_t*)&reply, sizeof(reply) }, 1, SDTP_HANDSHAKE, 5));
+	CHECK(test_wire_deliver(&a_out, b));
+	sdtp_dispatch(b);
+	CHECK(sdtp_link_get_state(b) == SDTP_LINK_DOWN);
+	CHECK(b_out.len == 0);
+
+	sdtp_instance_close(a);
+	sdtp_instance_close(b);
+
+	return 0;
+}
@@ -0,0 +1,159 @@
+// Copyright (c) 2026 bazelik
+
+// Input parser: frames that share a read or arrive a byte at a time, garbage
+// and false start bytes in front of a frame, corrupt frames among good ones,
+// and views held while the next frame wraps around the buffer end.
+
+#include "test.h"
+
+#include <stdlib.h>
+
+// Serialized frame of size bytes filled from seed (0 - no memory)
+static size_t make_frame(uint8_t* out, const size_t size, const uint8_t seed, const uint32_t id) {
+	uint8_t payload[1024];
+	for (size_t i = 0; i < size; ++i) payload[i] = (uint8_t)(0x30 + (seed + i) % 64);
+
+	sdtp_packet_t* packet = sdtp_construct_packet_bytes(payload, size, SDTP_DATA_PACKET, id);
+	if (!packet) return 0;
+
+	size_t frame_size = 0;
+	uint8_t* frame = sdtp_serialize_packet(packet, &frame_size);
+	sdtp_packet_free(packet);
+	if (!frame) return 0;
+
+	memcpy(out, frame, frame_size);
+	free(frame);
+
+	return frame_size;
+}
+
+// Whether the view carries the frame make_frame() built
+static bool view_is(const sdtp_packet_view_t* view, const size_t size, const uint8_t seed, const uint32_t id) {
+	if (view->header.id != id || view->header.type != SDTP_DATA_PACKET || view->header.data_size != size) return false;
+
+	for (size_t i = 0; i < size; ++i) {
+		if (view->body[i] != (uint8_t)(0x30 + (seed + i) % 64)) return false;
+	}
+
+	return true;
+}
+
+int main(void) {
+	const sdtp_config_t config = { 0, 0, 1024, 0, NULL, false };
+
+	static test_wire_t out;
+	const sdtp_function_hooks_v2 hooks = test_wire_hooks(&out);
+
+	sdtp_instance_t* instance = sdtp_instance_create_v2(&config, &hooks);
+	CHECK(instance);
+	sdtp_buffer_t* input = sdtp_buffer_get_by_type(instance, SDTP_INPUT_BUFFER);
+	CHECK(input);
+
+	uint8_t stream[1024];
+	sdtp_packet_view_t views[8];
+
+	// Several frames in one read
+	size_t len = 0;
+	len += make_frame(stream + len, 40, 0, 100);
+	len += make_frame(stream + len, 0, 0, 101);
+	len += make_frame(stream + len, 200, 7, 102);
+	CHECK(sdtp_io_push(instance, stream, len));
+	CHECK(sdtp_read_packet_views(instance, views, 8) == 3);
+	CHECK(view_is(&views[0], 40, 0, 100));
+	CHECK(view_is(&views[1], 0, 0, 101));
+	CHECK(view_is(&views[2], 200, 7, 102));
+	for (size_t i = 0; i < 3; ++i) sdtp_packet_view_release(instance, &views[i]);
+	CHECK(sdtp_buffer_get_used_space(input) == 0);
+
+	// Frames split byte by byte
+	len = make_frame(stream, 50, 3, 200);
+	len += make_frame(stream + len, 60, 4, 201);
+	size_t taken = 0;
+	for (size_t i = 0; i < len; ++i) {
+		CHECK(sdtp_io_push(instance, stream + i, 1));
+		if (!sdtp_read_packet_view(instance, &views[0])) continue;
+
+		CHECK(view_is(&views[0], taken == 0 ? 50 : 60, taken == 0 ? 3 : 4, taken == 0 ? 200 : 201));
+		CHECK(i == (taken == 0 ? 50 + 17 : len - 1));
+		sdtp_packet_view_release(instance, &views[0]);
+		taken++;
+	}
+	CHECK(taken == 2);
+	CHECK(sdtp_buffer_get_used_space(input) == 0);
+
+	// Garbage and false start bytes in front of a frame
+	len = 0;
+	memcpy(stream, "noise", 5);
+	len += 5;
+
+	// Start byte whose header claims more than the buffer holds
+	const uint32_t huge[4] = { 1, 0x10000000u, SDTP_DATA_PACKET, 0 };
+	stream[len++] = SDTP_START_OF_HEADER;
+	memcpy(stream + len, huge, sizeof(huge));
+	len += sizeof(huge);
+
+	// Compact start byte before the compact header was negotiated
+	stream[len++] = SDTP_START_OF_COMPACT;
+	stream[len++] = 0x10;
+
+	// Start byte whose plausible frame overlaps the real one and fails its checksum
+	const uint32_t overlap[4] = { 0x33, 0x30, SDTP_DATA_PACKET, 0x5A5A5A5Au };
+	stream[len++] = SDTP_START_OF_HEADER;
+	memcpy(stream + len, overlap, sizeof(overlap));
+	len += sizeof(overlap);
+
+	len += make_frame(stream + len, 70, 9, 300);
+	CHECK(sdtp_io_push(instance, stream, len));
+	CHECK(sdtp_read_packet_view(instance, &views[0]));
+	CHECK(view_is(&views[0], 70, 9, 300));
+	sdtp_packet_view_release(instance, &views[0]);
+	CHECK(!sdtp_read_packet_view(instance, &views[0]));
+	CHECK(sdtp_buffer_get_used_space(input) == 0);
+
+	// Bad checksum, bad terminator, then a good frame
+	len = make_frame(stream, 30, 1, 400);
+	stream[20] ^= 0x01;
+	size_t bad = make_frame(stream + len, 30, 2, 401);
+	stream[len + bad - 1] = 0x00;
+	len += bad;
+	len += make_frame(stream + len, 30, 3, 402);
+	CHECK(sdtp_io_push(instance, stream, len));
+	CHECK(sdtp_read_packet_views(instance, views, 8) == 1);
+	CHECK(view_is(&views[0], 30, 3, 402));
+	sdtp_packet_view_release(instance, &views[0]);
+	CHECK(sdtp_buffer_get_used_space(input) == 0);
+
+	// Move the ring position close to the end, an empty buffer rewinds
+	len = make_frame(stream, 600, 0, 500);
+	len += make_frame(stream + len, 150, 5, 501);
+	CHECK(sdtp_io_push(instance, stream, len));
+	sdtp_packet_t* packet = sdtp_read_packet(instance, SDTP_READ_PARTIAL);
+	CHECK(packet && packet->header.id == 500);
+	sdtp_packet_free(packet);
+
+	// First view stays put while the next body wraps into the scratch copy
+	CHECK(sdtp_read_packet_view(instance, &views[0]));
+	CHECK(view_is(&views[0], 150, 5, 501));
+
+	len = make_frame(stream, 300, 6, 502);
+	CHECK(sdtp_io_push(instance, stream, len));
+	CHECK(sdtp_read_packet_view(instance, &views[1]));
+	CHECK(views[1].body == instance->view_scratch);
+	CHECK(view_is(&views[1], 300, 6, 502));
+	CHECK(view_is(&views[0], 150, 5, 501));
+
+	// Held bytes aren't overwritten while the views are out
+	len = make_frame(stream, 100, 8, 503);
+	CHECK(sdtp_io_push(instance, stream, len));
+	CHECK(sdtp_read_packet_view(instance, &views[2]));
+	CHECK(view_is(&views[2], 100, 8, 503));
+	CHECK(view_is(&views[1], 300, 6, 502));
+	CHECK(view_is(&views[0], 150, 5, 501));
+
+	for (size_t i = 0; i < 3; ++i) sdtp_packet_view_release(instance, &views[i]);
+	CHECK(sdtp_buffer_get_used_space(input) == 0);
+
+	sdtp_instance_close(instance);
+
+	return 0;
+}
@@ -0,0 +1,191 @@
+// Copyright (c) 2026 bazelik
+
+// Output queue under concurrent producers: every frame arrives intact and in
+// its producer's order, records wrap around the queue end, and a record that
+// was reserved first but committed last holds back the ones behind it.
+
+#define _GNU_SOURCE
+
+#include "test.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+
+#define PRODUCERS 4
+#define PACKETS_PER_PRODUCER 20000
+
+typedef struct {
+	sdtp_instance_t* instance;
+	uint8_t producer;
+	uint32_t count;
+} producer_t;
+
+static size_t payload_size(const uint32_t seq) {
+	return sizeof(uint8_t) + sizeof(uint32_t) + (seq * 7) % 53;
+}
+
+// Producer number, sequence, then bytes derived from both
+static size_t fill_payload(uint8_t* payload, const uint8_t producer, const uint32_t seq) {
+	const size_t size = payload_size(seq);
+
+	payload[0] = producer;
+	memcpy(payload + 1, &seq, sizeof(seq));
+	for (size_t i = 5; i < size; ++i) payload[i] = (uint8_t)(producer * 31 + seq + i);
+
+	return size;
+}
+
+static bool payload_valid(const sdtp_packet_t* packet, uint8_t* producer, uint32_t* seq) {
+	if (packet->header.data_size < 5) return false;
+
+	*producer = packet->body[0];
+	memcpy(seq, packet->body + 1, sizeof(*seq));
+
+	uint8_t expected[64];
+	const size_t size = fill_payload(expected, *producer, *seq);
+
+	return packet->header.data_size == size && packet->header.id == *seq &&
+	       memcmp(packet->body, expected, size) == 0;
+}
+
+static void* produce(void* arg) {
+	const producer_t* producer = (const producer_t*)arg;
+
+	uint8_t payload[64];
+	for (uint32_t seq = 0; seq < producer->count; ++seq) {
+		const size_t size = fill_payload(payload, producer->producer, seq);
+		const sdtp_packet_t packet = { { seq, (uint32_t)size, SDTP_DATA_PACKET, 0 }, payload, NULL, false };
+
+		// Full queue: wait for the flusher
+		while (!sdtp_enqueue_packet(producer->instance, &packet)) sched_yield();
+	}
+
+	return NULL;
+}
+
+// Moves flushed frames to the reader, returns frames read or SIZE_MAX on a bad one
+static size_t drain(sdtp_instance_t* writer, test_wire_t* wire, sdtp_instance_t* reader, uint32_t* next_seq) {
+	sdtp_flush_queue(writer);
+	if (!test_wire_deliver(wire, reader)) return SIZE_MAX;
+
+	size_t count = 0;
+	sdtp_packet_t* packet;
+	while ((packet = sdtp_read_packet(reader, SDTP_READ_PARTIAL)) != NULL) {
+		uint8_t producer = 0;
+		uint32_t seq = 0;
+		const bool valid = payload_valid(packet, &producer, &seq) && producer < PRODUCERS && seq == next_seq[producer];
+		sdtp_packet_free(packet);
+		if (!valid) return SIZE_MAX;
+
+		next_seq[producer]++;
+		count++;
+	}
+
+	return count;
+}
+
+int main(void) {
+	const sdtp_config_t writer_config = { 0, 0, 1024, 0, NULL, false };
+	const sdtp_config_t reader_config = { 0, 0, 65536, 0, NULL, false };
+
+	static test_wire_t wire, unused;
+	const sdtp_function_hooks_v2 writer_hooks = test_wire_hooks(&wire);
+	const sdtp_function_hooks_v2 reader_hooks = test_wire_hooks(&unused);
+
+	sdtp_instance_t* writer = sdtp_instance_create_v2(&writer_config, &writer_hooks);
+	sdtp_instance_t* reader = sdtp_instance_create_v2(&reader_config, &reader_hooks);
+	CHECK(writer && reader);
+
+	// Small queue, so records keep wrapping and producers keep finding it full
+	sdtp_queue_t* queue = sdtp_queue_create(1024, NULL);
+	CHECK(queue);
+	sdtp_instance_set_queue(writer, queue);
+
+	// Concurrent producers
+	pthread_t threads[PRODUCERS];
+	producer_t producers[PRODUCERS];
+	for (uint8_t i = 0; i < PRODUCERS; ++i) {
+		producers[i] = (producer_t){ writer, i, PACKETS_PER_PRODUCER };
+		CHECK(pthread_create(&threads[i], NULL, produce, &producers[i]) == 0);
+	}
+
+	uint32_t next_seq[PRODUCERS] = { 0 };
+	size_t total = 0;
+	while (total < PRODUCERS * PACKETS_PER_PRODUCER) {
+		const size_t count = drain(writer, &wire, reader, next_seq);
+		CHECK(count != SIZE_MAX);
+		total += count;
+
+		// Let producers run on a single core
+		if (count == 0) sched_yield();
+	}
+
+	for (size_t i = 0; i < PRODUCERS; ++i) {
+		CHECK(pthread_join(threads[i], NULL) == 0);
+		CHECK(next_seq[i] == PACKETS_PER_PRODUCER);
+	}
+	CHECK(atomic_load(&queue->head) == atomic_load(&queue->tail));
+
+	// Records wrap around the queue end
+	memset(next_seq, 0, sizeof(next_seq));
+	size_t wrapped = 0;
+	uint8_t payload[64];
+	for (uint32_t seq = 0; seq < 200; ++seq) {
+		const size_t size = fill_payload(payload, 1, seq);
+		const sdtp_packet_t packet = { { seq, (uint32_t)size, SDTP_DATA_PACKET, 0 }, payload, NULL, false };
+
+		const size_t position = atomic_load(&queue->tail) & queue->mask;
+		if (position + SDTP_QUEUE_RECORD_SIZE(SDTP_FRAME_SIZE(size)) > queue->size) wrapped++;
+
+		CHECK(sdtp_enqueue_packet(writer, &packet));
+		if (seq % 3 == 2) CHECK(drain(writer, &wire, reader, next_seq) == 3);
+	}
+	CHECK(drain(writer, &wire, reader, next_seq) == 2);
+	CHECK(next_seq[1] == 200);
+	CHECK(wrapped > 0);
+
+	// Slow producer reserves its record first, then stalls before the commit
+	memset(next_seq, 0, sizeof(next_seq));
+	const size_t slow_size = fill_payload(payload, 2, 0);
+	sdtp_packet_t* slow = sdtp_construct_packet_bytes(payload, slow_size, SDTP_DATA_PACKET, 0);
+	CHECK(slow);
+	const size_t slow_frame_size = SDTP_FRAME_SIZE(slow_size);
+	const size_t slow_record_size = SDTP_QUEUE_RECORD_SIZE(slow_frame_size);
+	const size_t slow_tail = atomic_fetch_add(&queue->tail, slow_record_size);
+
+	// Another producer commits two records behind it
+	for (uint32_t seq = 1; seq < 3; ++seq) {
+		uint8_t fast_payload[64];
+		const size_t size = fill_payload(fast_payload, 2, seq);
+		const sdtp_packet_t packet = { { seq, (uint32_t)size, SDTP_DATA_PACKET, 0 }, fast_payload, NULL, false };
+		CHECK(sdtp_enqueue_packet(writer, &packet));
+	}
+
+	// Nothing goes out while the oldest record is uncommitted
+	CHECK(sdtp_flush_queue(writer) == 0);
+	CHECK(wire.len == 0);
+
+	// Commit the slow record the way a producer does: frame, then the record size
+	size_t frame_size = 0;
+	uint8_t* frame = sdtp_serialize_packet(slow, &frame_size);
+	sdtp_packet_free(slow);
+	CHECK(frame && frame_size == slow_frame_size);
+	for (size_t i = 0; i < frame_size; ++i) {
+		queue->data[(slow_tail + SDTP_QUEUE_RECORD_HEADER_SIZE + i) & queue->mask] = frame[i];
+	}
+	free(frame);
+	atomic_store(&queue->words[((slow_tail + sizeof(uint32_t)) & queue->mask) / sizeof(uint32_t)], (uint32_t)frame_size);
+	atomic_store(&queue->words[(slow_tail & queue->mask) / sizeof(uint32_t)], (uint32_t)slow_record_size);
+
+	// All three go out in reservation order
+	CHECK(drain(writer, &wire, reader, next_seq) == 3);
+	CHECK(next_seq[2] == 3);
+
+	sdtp_instance_set_queue(writer, NULL);
+	sdtp_queue_free(queue);
+	sdtp_instance_close(writer);
+	sdtp_instance_close(reader);
+
+	return 0;
+}
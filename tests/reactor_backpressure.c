@@ -0,0 +1,104 @@
+// Copyright (c) 2026 bazelik
+
+// One link whose peer never reads must not stall the reactor,
+// its output waits until the peer drains the socket.
+
+#include "test.h"
+
+#include <hal/libsdtp_hal_linux.h>
+
+#define PAYLOAD_SIZE 1000
+
+static size_t received;
+
+static void on_packet(sdtp_instance_t* instance, const sdtp_packet_view_t* view, void* ctx) {
+	(void)instance;
+	(void)ctx;
+
+	if (view->header.data_size == PAYLOAD_SIZE) received++;
+}
+
+int main(void) {
+	const sdtp_config_t config = { 0, 0, 4096, 0, NULL, false };
+
+	// Stuck link: local end in the reactor, peer end never read until the end
+	sdtp_hal_linux_t stuck_local, stuck_peer;
+	CHECK(sdtp_hal_pair_open(&stuck_local, &stuck_peer));
+	sdtp_instance_t* stuck = sdtp_instance_create_v2(&config, sdtp_hal_hooks(&stuck_local));
+	sdtp_instance_t* stuck_reader = sdtp_instance_create_v2(&config, sdtp_hal_hooks(&stuck_peer));
+	CHECK(stuck && stuck_reader);
+
+	// Live link: its peer keeps sending
+	sdtp_hal_linux_t live_local, live_peer;
+	CHECK(sdtp_hal_pair_open(&live_local, &live_peer));
+	sdtp_instance_t* live = sdtp_instance_create_v2(&config, sdtp_hal_hooks(&live_local));
+	sdtp_instance_t* live_sender = sdtp_instance_create_v2(&config, sdtp_hal_hooks(&live_peer));
+	CHECK(live && live_sender);
+
+	sdtp_reactor_t reactor;
+	CHECK(sdtp_reactor_init(&reactor));
+
+	sdtp_reactor_link_t stuck_link = { .instance = stuck, .driver = &stuck_local, .on_packet = on_packet };
+	sdtp_reactor_link_t live_link = { .instance = live, .driver = &live_local, .on_packet = on_packet };
+	CHECK(sdtp_reactor_add(&reactor, &stuck_link));
+	CHECK(sdtp_reactor_add(&reactor, &live_link));
+
+	// Fill the socket of the stuck link, every write returns right away
+	uint8_t payload[PAYLOAD_SIZE];
+	memset(payload, 0x5A, sizeof(payload));
+	const sdtp_iovec_t body = { payload, sizeof(payload) };
+
+	size_t written = 0;
+	while (sdtp_output_pending(stuck) == 0) {
+		CHECK(sdtp_write_packet_iov(stuck, &body, 1, SDTP_DATA_PACKET, (uint32_t)written));
+		written++;
+		CHECK(written < 100000);
+	}
+	CHECK(sdtp_reactor_update(&reactor, &stuck_link));
+	CHECK(stuck_link.write_armed);
+
+	// Live link is still served
+	for (int i = 0; i < 10; ++i) {
+		CHECK(sdtp_write_packet_iov(live_sender, &body, 1, SDTP_DATA_PACKET, 1));
+	}
+	for (int i = 0; i < 100 && received < 10; ++i) {
+		CHECK(sdtp_reactor_run_once(&reactor, 10) >= 0);
+	}
+	CHECK(received == 10);
+
+	// Writable events stay armed while the peer doesn't read
+	CHECK(stuck_link.write_armed);
+	CHECK(sdtp_output_pending(stuck) > 0);
+
+	// Peer drains the socket, the reactor resumes the partial write
+	size_t drained = 0;
+	for (int i = 0; i < 10000 && drained < written; ++i) {
+		sdtp_packet_t* packet;
+		while ((packet = sdtp_read_packet(stuck_reader, SDTP_READ_PARTIAL)) != NULL) {
+			CHECK(packet->header.id == (uint32_t)drained);
+			CHECK(packet->header.data_size == PAYLOAD_SIZE);
+			sdtp_packet_free(packet);
+			drained++;
+		}
+
+		CHECK(sdtp_reactor_run_once(&reactor, 1) >= 0);
+	}
+	CHECK(drained == written);
+	CHECK(sdtp_output_pending(stuck) == 0);
+	CHECK(!stuck_link.write_armed);
+
+	sdtp_reactor_remove(&reactor, &stuck_link);
+	sdtp_reactor_remove(&reactor, &live_link);
+	sdtp_reactor_close(&reactor);
+
+	sdtp_instance_close(stuck);
+	sdtp_instance_close(stuck_reader);
+	sdtp_instance_close(live);
+	sdtp_instance_close(live_sender);
+	sdtp_hal_close(&stuck_local);
+	sdtp_hal_close(&stuck_peer);
+	sdtp_hal_close(&live_local);
+	sdtp_hal_close(&live_peer);
+
+	return 0;
+}
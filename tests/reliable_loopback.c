@@ -0,0 +1,208 @@
+// Copyright (c) 2026 bazelik
+
+// Reliable frames over a wire which drops and reorders them: lost frames are
+// repaired after the retransmit timeout, acknowledged ones are not sent again,
+// duplicates are suppressed, frames are delivered in order and a peer which
+// never answers brings the link down.
+
+#include "test.h"
+
+#include <stdlib.h>
+
+static uint64_t now_us;
+
+static uint64_t fake_clock(void* ctx) {
+	(void)ctx;
+
+	return now_us;
+}
+
+// Checks every block is freed with the size it was allocated with
+static size_t size_mismatches;
+
+static void* sized_alloc(void* ctx, const size_t size) {
+	(void)ctx;
+
+	size_t* block = (size_t*)malloc(sizeof(size_t) + size);
+	if (!block) return NULL;
+
+	*block = size;
+	return block + 1;
+}
+
+static void sized_free(void* ctx, void* ptr, const size_t size) {
+	(void)ctx;
+	if (!ptr) return;
+
+	size_t* block = (size_t*)ptr - 1;
+	if (*block != size) size_mismatches++;
+	free(block);
+}
+
+static const sdtp_allocator_t sized = { sized_alloc, sized_free, NULL };
+
+static uint32_t delivered[64];
+static size_t received;
+
+static void on_data(sdtp_instance_t* instance, const sdtp_packet_view_t* view, void* ctx) {
+	(void)instance;
+	(void)ctx;
+
+	if (received < sizeof(delivered) / sizeof(delivered[0])) delivered[received] = view->header.id;
+	received++;
+}
+
+// Frames taken off the wire, to be pushed in any order
+typedef struct {
+	uint8_t data[8][512];
+	size_t size[8];
+	size_t count;
+} frames_t;
+
+static size_t take_frames(test_wire_t* wire, frames_t* frames) {
+	frames->count = 0;
+	while (frames->count < 8) {
+		const size_t size = test_wire_take_frame(wire, frames->data[frames->count]);
+		if (size == 0) break;
+		frames->size[frames->count++] = size;
+	}
+
+	return frames->count;
+}
+
+static bool push_frame(sdtp_instance_t* peer, const frames_t* frames, const size_t index) {
+	return sdtp_io_push(peer, frames->data[index], frames->size[index]);
+}
+
+static sdtp_instance_t* open_end(const sdtp_function_hooks_v2* hooks) {
+	const sdtp_config_t config = { 0, 0, 4096, 0, &sized, false };
+	const sdtp_reliable_config_t reliable = { 8, 0, 1000, 1000, 64000, 3 };
+
+	sdtp_instance_t* instance = sdtp_instance_create_v2(&config, hooks);
+	if (!instance) return NULL;
+
+	sdtp_instance_set_clock(instance, fake_clock, NULL);
+	if (!sdtp_instance_set_reliable(instance, &reliable, NULL)) {
+		sdtp_instance_close(instance);
+		return NULL;
+	}
+
+	return instance;
+}
+
+int main(void) {
+	static test_wire_t a_out, b_out;
+	static frames_t frames;
+	const sdtp_function_hooks_v2 a_hooks = test_wire_hooks(&a_out);
+	const sdtp_function_hooks_v2 b_hooks = test_wire_hooks(&b_out);
+
+	sdtp_instance_t* a = open_end(&a_hooks);
+	sdtp_instance_t* b = open_end(&b_hooks);
+	CHECK(a && b);
+	CHECK(sdtp_set_handler(b, SDTP_DATA_PACKET, on_data, NULL));
+
+	CHECK(sdtp_link_connect(a, 100));
+	CHECK(test_wire_deliver(&a_out, b));
+	sdtp_dispatch(b);
+	CHECK(test_wire_deliver(&b_out, a));
+	sdtp_dispatch(a);
+	CHECK(sdtp_link_get_state(a) == SDTP_LINK_UP);
+
+	const uint8_t payload[24] = { 0x5A, 0xA5 };
+	const sdtp_iovec_t body = { payload, sizeof(payload) };
+
+	// Second frame is lost, the last two arrive swapped
+	for (uint32_t id = 0; id < 4; ++id) {
+		CHECK(sdtp_write_reliable_iov(a, &body, 1, SDTP_DATA_PACKET, id));
+	}
+	CHECK(take_frames(&a_out, &frames) == 4);
+	CHECK(push_frame(b, &frames, 0));
+	CHECK(push_frame(b, &frames, 3));
+	CHECK(push_frame(b, &frames, 2));
+	sdtp_dispatch(b);
+
+	// Frames behind the gap are held
+	CHECK(received == 1 && delivered[0] == 0);
+
+	// Selective ack releases everything but the lost frame
+	CHECK(test_wire_deliver(&b_out, a));
+	sdtp_dispatch(a);
+	CHECK(sdtp_reliable_in_flight(a) == 3);
+	CHECK(a_out.len == 0);
+
+	// Nothing is repaired before the timeout
+	now_us += 999;
+	CHECK(sdtp_reliable_poll(a) == 0);
+	CHECK(a_out.len == 0);
+
+	// Only the lost frame goes out again
+	now_us += 1;
+	CHECK(sdtp_reliable_poll(a) == 1);
+	CHECK(a->reliable.retransmits == 1);
+	CHECK(take_frames(&a_out, &frames) == 1);
+	CHECK(push_frame(b, &frames, 0));
+	sdtp_dispatch(b);
+
+	CHECK(received == 4);
+	for (uint32_t id = 0; id < 4; ++id) {
+		CHECK(delivered[id] == id);
+	}
+
+	CHECK(test_wire_deliver(&b_out, a));
+	sdtp_dispatch(a);
+	CHECK(sdtp_reliable_in_flight(a) == 0);
+
+	// Duplicate is acknowledged again but not delivered
+	CHECK(push_frame(b, &frames, 0));
+	sdtp_dispatch(b);
+	CHECK(received == 4);
+	CHECK(b_out.len > 0);
+	CHECK(test_wire_deliver(&b_out, a));
+	sdtp_dispatch(a);
+
+	// Copying reads return held frames in order too
+	CHECK(sdtp_write_reliable_iov(a, &body, 1, SDTP_DATA_PACKET, 4));
+	CHECK(sdtp_write_reliable_iov(a, &body, 1, SDTP_DATA_PACKET, 5));
+	CHECK(take_frames(&a_out, &frames) == 2);
+	CHECK(push_frame(b, &frames, 1));
+	CHECK(push_frame(b, &frames, 0));
+
+	for (uint32_t id = 4; id < 6; ++id) {
+		sdtp_packet_t* packet = sdtp_read_packet(b, SDTP_READ_PARTIAL);
+		CHECK(packet);
+		CHECK(packet->header.id == id && packet->header.data_size == sizeof(payload));
+		CHECK(memcmp(packet->body, payload, sizeof(payload)) == 0);
+		sdtp_packet_free(packet);
+	}
+	CHECK(sdtp_read_packet(b, SDTP_READ_PARTIAL) == NULL);
+
+	CHECK(test_wire_deliver(&b_out, a));
+	sdtp_dispatch(a);
+	CHECK(sdtp_reliable_in_flight(a) == 0);
+
+	// Peer that never answers: max_retries retransmits, then the link is down
+	const size_t retransmits = a->reliable.retransmits;
+	CHECK(sdtp_write_reliable_iov(a, &body, 1, SDTP_DATA_PACKET, 6));
+	a_out.len = 0;
+
+	for (uint32_t retry = 0; retry < 3; ++retry) {
+		now_us += 64000;
+		CHECK(sdtp_reliable_poll(a) == 1);
+		CHECK(a_out.len > 0);
+		a_out.len = 0;
+	}
+	CHECK(a->reliable.retransmits == retransmits + 3);
+	CHECK(sdtp_link_get_state(a) == SDTP_LINK_UP);
+
+	now_us += 64000;
+	CHECK(sdtp_reliable_poll(a) == 0);
+	CHECK(sdtp_link_get_state(a) == SDTP_LINK_DOWN);
+	CHECK(a->reliable.failures == 1);
+	CHECK(sdtp_reliable_in_flight(a) == 0);
+
+	sdtp_instance_close(a);
+	sdtp_instance_close(b);
+	CHECK(size_mismatches == 0);
+
+	return 0;
+}
@@ -0,0 +1,86 @@
+// Copyright (c) 2026 bazelik
+
+// Helpers shared by the tests
+
+#ifndef SDTP_TEST_H
+#define SDTP_TEST_H
+
+#include <api/libsdtp.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#define CHECK(condition)                                                   \
+	do {                                                                   \
+		if (!(condition)) {                                                \
+			fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+			return 1;                                                      \
+		}                                                                  \
+	} while (0)
+
+// Bytes written by one end, delivered to the other by hand
+typedef struct {
+	uint8_t data[65536];
+	size_t len;
+} test_wire_t;
+
+static inline size_t test_wire_read(void* ctx, uint8_t* buffer, const size_t capacity) {
+	(void)ctx;
+	(void)buffer;
+	(void)capacity;
+
+	return 0;
+}
+
+// Takes whole segments while they fit, like a channel that is busy once full
+static inline size_t test_wire_writev(void* ctx, const sdtp_iovec_t* iov, const size_t count) {
+	test_wire_t* wire = (test_wire_t*)ctx;
+
+	size_t written = 0;
+	for (size_t i = 0; i < count; ++i) {
+		if (iov[i].len > sizeof(wire->data) - wire->len) break;
+
+		memcpy(wire->data + wire->len, iov[i].base, iov[i].len);
+		wire->len += iov[i].len;
+		written += iov[i].len;
+	}
+
+	return written;
+}
+
+static inline sdtp_function_hooks_v2 test_wire_hooks(test_wire_t* wire) {
+	return (sdtp_function_hooks_v2){ wire, test_wire_read, test_wire_writev };
+}
+
+// Moves everything written by one end to the other
+static inline bool test_wire_deliver(test_wire_t* wire, sdtp_instance_t* peer) {
+	const bool pushed = wire->len == 0 || sdtp_io_push(peer, wire->data, wire->len);
+	wire->len = 0;
+
+	return pushed;
+}
+
+// Size of the frame at the start of the wire (0 - incomplete or not a frame)
+static inline size_t test_wire_frame_size(const test_wire_t* wire) {
+	sdtp_packet_header_t header;
+	size_t checksum_size = 0;
+	const size_t head_size = sdtp_header_decode(wire->data, wire->len, &header, &checksum_size);
+	if (head_size == 0 || head_size == SIZE_MAX) return 0;
+
+	const size_t frame_size = head_size + (size_t)header.data_size + 1;
+	return frame_size <= wire->len ? frame_size : 0;
+}
+
+// Removes the frame at the start of the wire, copying it out if frame isn't NULL
+static inline size_t test_wire_take_frame(test_wire_t* wire, uint8_t* frame) {
+	const size_t frame_size = test_wire_frame_size(wire);
+	if (frame_size == 0) return 0;
+
+	if (frame) memcpy(frame, wire->data, frame_size);
+	memmove(wire->data, wire->data + frame_size, wire->len - frame_size);
+	wire->len -= frame_size;
+
+	return frame_size;
+}
+
+#endif //SDTP_TEST_H